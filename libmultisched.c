@@ -0,0 +1,3617 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <time.h>
+#include "multisched.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+#define MSG(x...) fprintf (stderr, x)
+#define ERR(s, x...) fprintf ((s)->err, x)				// diagnostics of a workload
+#define STRERROR  strerror (errno)
+
+/** constraints **/
+#define ID_LEN 2									// default id string length limit
+#define PRIORITY_LEN 2						// priority string length limit
+
+#define MAX_PRIORITY 10						// priority limit
+#define MAX_ARRIVE_TIME 30				// default arrive time limit
+#define MAX_SERVICE_TIME 30				// default service time limit
+#define MIN_ARRIVE_TIME 0
+#define MIN_SERVICE_TIME 1
+#define MIN_PRIORITY 1
+
+#define H_TIME_QUANTUM 6					// default time quantum of H tasks
+#define M_TIME_QUANTUM 4					// default time quantum of M tasks
+
+/* limits of the large workload mode (-L) */
+#define LARGE_ID_LEN 64
+#define LARGE_MAX_TIME 1000000000000LL	// 10^12 ticks
+#define MAX_TIME_LIMIT 999999999999999999LL	// 18 digits, parsed without overflow
+
+/* parallel parsing */
+#define MAX_PARSE_THREADS 16					// default parser threads limit
+#define CHUNKS_PER_THREAD 4						// chunks per parser thread
+#define PARALLEL_PARSE_SIZE (1 << 20)	// smaller files are parsed serially
+
+/* binary workload format */
+#define BINARY_MAGIC "MSCHDBIN"				// first bytes of a binary workload
+#define BINARY_VERSION 1
+#define CHECKSUM_SEED 14695981039346656037UL
+
+/* workload generator */
+#define GEN_BUFFER_SIZE (1 << 20)			// output buffer, a multiple of 8 bytes
+#define GEN_ID_PREFIX 'T'							// ids are T followed by the task number
+
+/* arena of the run */
+#define ARENA_BLOCK_SIZE (1 << 20)		// default arena block size
+#define ARENA_ALIGN 16								// alignment of arena allocations
+
+/* task table */
+#define NO_TASK UINT32_MAX						// no task, ends a list of tasks
+#define TASK_TABLE_MIN 1024						// initial number of task slots
+
+#define PAGE_SIZE_MIN 4096						// vector loads never cross such a page
+
+/* latency histograms */
+#define HIST_SUB_BITS 7								// 128 buckets per power of two, < 0.8% error
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+#ifndef EVENT_DRIVEN
+#define EVENT_DRIVEN 1						// skip ticks on which nothing can change, 0 for the tick loop
+#endif
+#define DEBUG 0
+#ifndef PROFILE
+#define PROFILE 0									// hot path counters and phase timing
+#endif
+
+/* profile counters and phase cycles, compiled out unless PROFILE is set */
+#define PROF_COUNT(s, counter, n) do { if (PROFILE) (s)->prof.counter += (n); } while (0)
+#define PROF_PHASE(s, phase, t) do {																\
+    if (PROFILE) {																									\
+      uint64_t now_ = prof_clock ();																\
+      (s)->prof.cycles[phase] += now_ - (t);												\
+      (t) = now_;																									\
+    }																															\
+  } while (0)
+
+
+/** declarations **/
+
+/* type declarations */
+typedef struct _Task Task;
+typedef struct _TaskTable TaskTable;
+typedef uint32_t TaskRef;				// index of a task in the task table					
+typedef struct _Queue Queue;
+typedef struct _CPU CPU;
+typedef struct _GanttNode Node;
+typedef struct _Run Run;
+typedef struct _GanttList GanttList;
+typedef enum _Type Type;				
+typedef struct _Limits Limits;
+typedef struct _IndexSlot IndexSlot;
+typedef struct _TaskIndex TaskIndex;
+typedef struct _Slice Slice;
+typedef enum _LineStatus LineStatus;
+typedef struct _ParsedLine ParsedLine;
+typedef struct _Chunk Chunk;
+typedef struct _ParseJob ParseJob;
+typedef struct _SweepJob SweepJob;
+typedef struct _BatchReport BatchReport;
+typedef struct _BatchJob BatchJob;
+typedef struct _GenRng GenRng;
+typedef struct _GenWriter GenWriter;
+typedef struct _GenState GenState;
+typedef struct _BinaryHeader BinaryHeader;
+typedef enum _Column Column;
+typedef struct _Arena Arena;
+typedef struct _ArenaBlock ArenaBlock;
+typedef enum _Phase Phase;
+typedef struct _Profile Profile;
+typedef enum _Latency Latency;
+typedef struct _Histogram Histogram;
+typedef long long Time;					// simulated time in ticks
+typedef long double TimeSum;		// sum of the times of many tasks, which overflows Time
+
+/* arena related function declarations */
+static void *arena_alloc(Arena *, size_t);
+static char *arena_strndup(Arena *, const char *, size_t);
+static void arena_free(Arena *, void *, size_t);
+static void arena_adopt(Arena *, Arena *);
+static void arena_release(Arena *);
+static void free_run(Sched *);
+
+/* parser related function declarations */
+static int check_valid_id(const Limits *, const char *, size_t);
+static const char *lookup_id(TaskIndex *, const char *, size_t, unsigned long);
+static unsigned long hash_id(const char *, size_t);
+static int index_id(TaskIndex *, const char *, unsigned long);
+static void unindex_id(TaskIndex *, const char *, unsigned long);
+static int parse_digits_scalar(const char *, size_t, Time *);
+static int find_spaces_scalar(const char *, size_t, const char **, int);
+#ifdef HAVE_X86_SIMD
+static int parse_digits_sse41(const char *, size_t, Time *);
+static int find_spaces_sse2(const char *, size_t, const char **, int);
+static int find_spaces_avx2(const char *, size_t, const char **, int);
+#endif
+static void init_simd();
+static int check_valid_arrive_time(const Limits *, const char *, size_t, Time *);
+static int check_valid_service_time(const Limits *, const char *, size_t, Time *);
+static int check_valid_priority(const char *, size_t, int *);
+static int grow_table(Sched *, TaskRef);
+static TaskRef append_task(Sched *, Task *);
+static void release_task(Sched *, TaskRef);
+static LineStatus parse_line(const Limits *, const char *, size_t, Task *, Slice *, Slice *);
+static void report_line(Sched *, ParsedLine *);
+static void *parse_chunks(void *);
+static void *find_duplicates(void *);
+static void run_parallel(int, void *(*)(void *), void *);
+static TaskRef sort_tasks(Sched *, TaskRef);
+
+/* sweep related function declarations */
+static void *run_sweep(void *);
+
+/* batch related function declarations */
+static void *run_batch(void *);
+static void print_batch_reports(BatchJob *);
+
+/* streaming related function declarations */
+static int open_stream(Sched *, const char *);
+static void read_stream(Sched *);
+static void finish_task(Sched *, TaskRef, Time);
+
+/* generator related function declarations */
+static uint64_t gen_next(GenRng *);
+static double gen_uniform(GenRng *);
+static void gen_seed(GenRng *, uint64_t, uint64_t);
+static int gen_pick(GenRng *, const double *, int);
+static Time gen_arrive_time(GenState *);
+static Time gen_service_time(GenState *);
+static void gen_put(GenWriter *, const void *, size_t);
+static void gen_align(GenWriter *);
+static int gen_flush(GenWriter *);
+static int gen_format(char *, unsigned long long, int);
+static int gen_text(GenState *, FILE *);
+static int gen_binary(GenState *, FILE *);
+
+/* binary workload related function declarations */
+static unsigned long checksum(const void *, size_t, unsigned long);
+static void binary_layout(uint64_t, uint64_t, uint64_t *);
+static int write_binary(Sched *, const char *);
+static int load_binary(Sched *, const char *, size_t, const char *);
+
+/* queue related function declarations */
+static Queue *get_queue(Sched *, Type);
+static void enqueue_task(Sched *, TaskRef);
+static TaskRef dequeue_task(Sched *, Queue *);
+static bool is_empty(Queue *);
+static void init_queue(Queue *, Type);
+static bool heap_before(Sched *, TaskRef, TaskRef);
+static void heap_push(Sched *, Queue *, TaskRef);
+static TaskRef heap_pop(Sched *, Queue *);
+static TaskRef heap_remove(Sched *, Queue *, int);
+
+/* scheduling algorithm related function declarations */
+static void switch_cpu(Sched *, int);
+static int place_task(Sched *, TaskRef);
+static CPU *find_victim(Sched *, int);
+static bool steal_task(Sched *, int);
+static void long_term_schedule(Sched *);
+static Time next_event_span(Sched *);
+static void process(Sched *, Time);
+static void short_term_schedule(Sched *);
+static void priority_interrupt_check(Sched *);
+static void timeout_check(Sched *);
+static double get_average(Sched *, const TimeSum *);
+
+/* gantt related function declarations */
+static Node *add_gantt_node(Sched *, TaskRef);
+static void record_to_gantt(Sched *, TaskRef, Time, Time);
+static void print_gantt(Sched *, FILE *);
+static void print_cpus(Sched *, FILE *);
+
+/* latency histogram related function declarations */
+static Histogram *get_histogram(Sched *, Type, Latency);
+static int hist_bucket(Time);
+static Time hist_value(int);
+static void hist_record(Histogram *, Time);
+static void hist_merge(Histogram *, const Histogram *);
+static Time hist_percentile(const Histogram *, double);
+static void print_latency(Sched *, FILE *);
+
+/* profile related function declarations */
+static inline uint64_t prof_clock();
+static void print_profile(Sched *, FILE *);
+
+/* tokenizer and digit converter picked for this cpu by init_simd() */
+static int (*parse_digits)(const char *, size_t, Time *) = parse_digits_scalar;
+static int (*find_spaces)(const char *, size_t, const char **, int) = find_spaces_scalar;
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+#ifdef HAVE_X86_SIMD
+static int8_t digit_align[17][16];			// shuffle masks of parse_digits_sse41()
+#endif
+
+
+/** struct & enum definitions **/
+
+/* task Type */
+enum _Type {
+
+  H, M, L
+};
+
+/* workload limits checked by the parser */
+struct _Limits {
+
+  int id_len;                 // id string length limit
+  Time max_arrive_time;       // arrive time limit
+  Time max_service_time;      // service time limit
+};
+
+/* block of an arena, its allocations follow the header */
+struct _ArenaBlock {
+
+  ArenaBlock *next;           // next block, the head is allocated from
+  size_t size;                // bytes after the header
+  size_t used;                // bytes allocated
+};
+
+/* bump allocator released as a whole */
+struct _Arena {
+
+  ArenaBlock *head;           // current block, NULL if nothing was allocated
+  size_t blocks;              // number of blocks
+  size_t bytes;               // bytes of all blocks
+  void *free_list[64];        // freed allocations of 2^i bytes, for reuse
+};
+
+/* slot of the task id index */
+struct _IndexSlot {
+
+  unsigned long hash;         // hash of the id, compared before the id
+  const char *id;             // indexed task id, NULL if the slot is free
+};
+
+/* hash index of task ids, open addressing with linear probing */
+struct _TaskIndex {
+
+  IndexSlot *slots;           // slots, a power of two of them
+  size_t cap;                 // number of slots
+  size_t count;               // number of indexed ids
+};
+
+/* field of a line in the mapped file, not NUL terminated */
+struct _Slice {
+
+  const char *str;            // first byte of the field
+  size_t len;                 // length of the field
+};
+
+/* result of parsing a line, in the order the fields are checked */
+enum _LineStatus {
+
+  LINE_SKIP,                  // comment or empty line
+  LINE_TASK,                  // valid task
+  LINE_INVALID_FORMAT,
+  LINE_INVALID_ID,
+  LINE_DUPLICATE_ID,
+  LINE_INVALID_ACTION,
+  LINE_INVALID_ARRIVE_TIME,
+  LINE_INVALID_SERVICE_TIME,
+  LINE_EMPTY_PRIORITY,
+  LINE_INVALID_PRIORITY,
+  LINE_NO_MEMORY
+};
+
+/* task structure, as parsed before it is appended to the task table */
+struct _Task {
+
+  Type type;                  // Type of the Task. H, M, L
+  char *id;                   // Id of the Task.
+  Time arrive_time;           // Arrive-time of the Task.
+  Time service_time;          // Service-time of the Task. 
+  int priority;               // Priority of the Task.
+};
+
+/* parsed line which is not a comment */
+struct _ParsedLine {
+
+  const char *line;           // line in the mapped file
+  const char *id;             // its valid id, NULL if there is none
+  Task task;                  // parsed task with LINE_TASK
+  unsigned long hash;         // hash of the id
+  int len;                    // length of the line
+  int id_len;                 // length of the id
+  int line_nr;                // line number, in the chunk until merged
+  LineStatus status;          // result of the line
+  int shard_next;             // next line of the same id shard, -1 at the end
+};
+
+/* newline aligned part of the data file parsed by one thread */
+struct _Chunk {
+
+  const char *start;          // first line
+  const char *end;            // end of the last line
+  int lines;                  // number of lines including comments
+  ParsedLine *parsed;         // parsed lines in order
+  size_t count;               // number of parsed lines
+  size_t cap;                 // number of parsed lines allocated
+  int shard_head[MAX_PARSE_THREADS];  // first line with an id of each shard
+  int shard_tail[MAX_PARSE_THREADS];  // last line with an id of each shard
+  Arena arena;                // tasks of the chunk, adopted by the run arena
+};
+
+/* work shared by the parser threads */
+struct _ParseJob {
+
+  const Limits *limits;       // limits of the run
+  Chunk *chunks;              // chunks in file order
+  int nr_chunks;              // number of chunks
+  int nr_shards;              // id hash partitions for duplicate checks
+  int next;                   // next chunk or shard to take
+};
+
+/* combinations of time quanta shared by the sweep threads */
+struct _SweepJob {
+
+  const Sched *workload;      // parsed tasks, only read
+  SchedConfig config;         // config of every run but its quanta
+  int h_min;                  // first H quantum
+  int m_min;                  // first M quantum
+  int nr_m;                   // number of M quanta
+  int nr_runs;                // number of combinations
+  int next;                   // next combination to run
+  int failed;                 // combinations which could not run
+  SchedResult *results;       // result of each combination
+};
+
+/* output of one workload of a batch, held until the ones before are printed */
+struct _BatchReport {
+
+  char *out;                  // report
+  size_t out_len;
+  char *err;                  // diagnostics
+  size_t err_len;
+  bool done;                  // simulated, ready to print
+};
+
+/* workload files shared by the batch threads */
+struct _BatchJob {
+
+  const char *const *files;   // workload files
+  int nr_files;               // number of files
+  SchedConfig config;         // config of every simulation
+  int next;                   // next file to simulate
+  int failed;                 // files which failed
+  SchedResult *results;       // result of each file
+  BatchReport *reports;       // output of each file
+  int printed;                // files printed so far, in order
+  pthread_mutex_t lock;       // guards done and printed
+};
+
+/* xoshiro256** generator, one per column so every column is reproducible alone */
+struct _GenRng {
+
+  uint64_t s[4];
+};
+
+/* buffered output of a generated binary workload, checksummed as it goes */
+struct _GenWriter {
+
+  FILE *fp;
+  char *buf;                  // GEN_BUFFER_SIZE bytes
+  size_t len;                 // bytes in buf
+  uint64_t pos;               // bytes of the payload so far
+  unsigned long checksum;     // checksum of the payload written out
+  int err;                    // errno of the first failed write
+};
+
+/* generator of one workload, the random streams of its columns */
+struct _GenState {
+
+  const SchedGenConfig *config;
+  GenRng arrive;              // arrival gaps and burst sizes
+  GenRng service;             // service times
+  GenRng type;                // H, M, L
+  GenRng priority;            // priorities
+  double clock;               // continuous arrival time
+  long long burst_left;       // tasks left of the current burst
+  int id_digits;              // digits of the task numbers in the ids
+  double type_cdf[3];         // cumulative weights of the types
+  double priority_cdf[MAX_PRIORITY];  // cumulative weights of the priorities
+};
+
+/* header of a binary workload, followed by its columns */
+struct _BinaryHeader {
+
+  char magic[8];              // BINARY_MAGIC
+  uint32_t version;           // BINARY_VERSION
+  uint32_t header_size;       // size of this header
+  uint64_t count;             // number of tasks
+  uint64_t id_bytes;          // size of the NUL terminated ids
+  uint64_t checksum;          // checksum of the columns
+};
+
+/* columns of a binary workload in file order, each padded to 8 bytes */
+enum _Column {
+
+  COL_ARRIVE_TIME,            // int64 per task
+  COL_SERVICE_TIME,           // int64 per task
+  COL_ID_OFFSET,              // uint64 per task, offset into COL_ID
+  COL_TYPE,                   // uint8 per task, Type
+  COL_PRIORITY,               // uint8 per task
+  COL_ID,                     // NUL terminated ids
+  NR_COLUMNS
+};
+
+/* tasks stored column by column and referred to by TaskRef, the columns
+   compared on every scheduling decision come first */
+struct _TaskTable {
+
+  Time *remaining_time;       // remaining time to service each task
+  unsigned long *seq;         // enqueue order, breaks ties in the M queue
+  uint8_t *priority;          // priority of each task
+  uint8_t *type;              // Type of each task
+  TaskRef *next;              // next task of the list or queue a task is in
+
+  Time *arrive_time;          // arrive time of each task
+  Time *service_time;         // service time of each task
+  Time *start_time;           // first tick each task ran
+  char **id;                  // id of each task
+  Node **node;                // gantt node recording each task
+
+  TaskRef count;              // slots handed out
+  TaskRef cap;                // slots allocated
+  TaskRef free;               // released slots chained by next, for streaming
+  TaskRef nr_free;            // number of released slots
+};
+
+/* queue structure */
+struct _Queue {
+
+  Type type;                  // type of the tasks in this queue
+  TaskRef head;               // head or front, NO_TASK if empty
+  TaskRef tail;               // tail or rear
+
+  /* H queue only: one FIFO list per priority, head is the front of the
+     highest non-empty priority */
+  TaskRef bucket_head[MAX_PRIORITY+1];
+  TaskRef bucket_tail[MAX_PRIORITY+1];
+  unsigned int occupied;      // bit p is set when priority p is not empty
+
+  /* M queue only: binary min-heap on (remaining time, enqueue order),
+     head is heap[0] */
+  TaskRef *heap;
+  int heap_size;
+  int heap_cap;
+  unsigned long seq;          // enqueue counter
+};
+
+/* cpu structure */
+struct _CPU {             
+
+  TaskRef task;             // task currently running, NO_TASK if idle
+  Type task_type;           // task type for recording which task was running
+  int timeout;              // timeout value for H and M
+  Queue *queue[3];          // run queues of this core, by Type
+
+  TaskRef last_task;        // task it ran last, for the profile
+  TimeSum load;             // remaining service time of its tasks
+  Time stall;               // ticks left taking a stolen task
+  Time busy;                // ticks it ran a task
+  long migrations;          // tasks stolen by this core
+  long completed;           // tasks completed on it
+  TimeSum turn_around_time; // sum over its completed tasks
+  TimeSum waiting_time;     // sum over its completed tasks
+};
+
+/* execution interval [start, end) of a task */
+struct _Run {
+
+  Time start;               // first tick the task ran
+  Time end;                 // tick after the last one the task ran
+};
+
+/* gantt node */
+struct _GanttNode {
+
+  Node *next;               // pointer which points the next gantt node
+  TaskRef task;             // each gantt node keep one task
+
+  char *id;                 // id of task
+  Run *runs;                // record of execution of its task, in time order
+  int run_count;            // number of runs recorded
+  int run_cap;              // number of runs allocated
+};
+
+/* gantt list */
+struct _GanttList {
+
+  Node *head;               // head of a list
+  Node *tail;               // tail of a list
+};
+
+/* latencies of a completed task */
+enum _Latency {
+
+  LAT_TURN_AROUND,            // complete time - arrive time
+  LAT_WAITING,                // turnaround time - service time
+  LAT_RESPONSE,               // first tick it ran - arrive time
+  NR_LATENCIES
+};
+
+/* log-linear histogram of latencies: values below HIST_SUB_COUNT have a
+   bucket each, larger ones share HIST_SUB_COUNT buckets per power of two;
+   two of them merge by adding their buckets */
+struct _Histogram {
+
+  long count;                 // values recorded
+  Time max;                   // largest value, exact
+  uint64_t bucket[HIST_BUCKETS];
+};
+
+/* phases of a scheduler step timed by the profile */
+enum _Phase {
+
+  PHASE_STREAM,               // read_stream
+  PHASE_LONG_TERM,            // long_term_schedule
+  PHASE_STEAL,                // steal_task
+  PHASE_SHORT_TERM,           // short_term_schedule, priority_interrupt_check
+  PHASE_PROCESS,              // next_event_span, process, timeout_check
+  NR_PHASES
+};
+
+/* hot path counters of a run, only kept when built with PROFILE */
+struct _Profile {
+
+  long steps;                 // scheduler steps
+  long context_switches;      // a core starts running another task
+  long preempt_h;             // H task preempted by a higher priority H
+  long preempt_l;             // L task preempted by an H or M
+  long expire_h;              // H quanta expired in timeout_check
+  long expire_m;              // M quanta expired in timeout_check
+  long enqueues;              // tasks enqueued
+  long enqueue_walk;          // M heap levels sifted through on enqueue
+  long max_enqueue_walk;      // most levels of one enqueue
+  Time idle_ticks;            // core ticks without a running task
+  uint64_t cycles[NR_PHASES]; // time stamp counter cycles of each phase
+};
+
+/* simulation context, everything one run of the scheduler works on */
+struct _Sched {
+
+  Limits limits;                // workload limits checked by the parser
+  int parse_threads;            // number of parser threads.
+  FILE *out;                    // streamed tasks are reported here
+  FILE *err;                    // diagnostics of the workload go here
+  long ignored;                 // input lines ignored
+
+  TaskTable table;              // all tasks of the run.
+  TaskRef tasks;                // list of tasks from the txt file.
+  TaskRef tasks_tail;           // last task of the list while parsing.
+  Arena arena;                  // tasks and gantt records of the run.
+  const char *mapped;           // binary workload mapping holding the ids.
+  size_t mapped_size;           // size of the mapping.
+  GanttList gantt_list;         // linked list of gantt node
+
+  FILE *stream;                 // streamed task lines, NULL once drained.
+  bool streaming;               // tasks are streamed and released when done.
+  char *stream_line;            // line buffer of the stream
+  size_t stream_cap;            // size of the line buffer
+  int stream_line_nr;           // lines read from the stream
+  TaskIndex live_tasks;         // streamed tasks which are not done yet.
+
+  Time now;                     // track current time.
+  bool running;                 // running flag
+  bool started;                 // the first step was taken
+  CPU *cpu;                     // cpu being scheduled, one of cpus
+  CPU *cpus;                    // simulated cores
+  int nr_cpus;                  // number of simulated cores
+  SchedPlacement placement;     // core an arriving task is queued on
+  int next_cpu;                 // next core of round robin placement
+  bool stealing;                // idle cores steal from busy ones
+  Time migration_penalty;       // ticks a core spends taking a stolen task
+  int h_quantum;                // time quantum of H tasks
+  int m_quantum;                // time quantum of M tasks
+  const Sched *workload;        // shares the input columns of this one, if any
+  Profile prof;                 // hot path counters, with PROFILE
+  Histogram *latency;           // latencies of completed tasks by Type and Latency
+
+  /* sums over the completed tasks by Type, added as each one completes */
+  long done[3];
+  TimeSum turn_around_time[3];
+  TimeSum waiting_time[3];
+  TimeSum response_time[3];
+  double weight[3];             // weights of the averages by Type
+  bool percentiles;             // report the latency percentiles
+
+  /* queue pointers of the cpu being scheduled */
+  Queue *H_queue;
+  Queue *M_queue;
+  Queue *L_queue;
+};
+
+
+/** function definitions **/
+
+/* size of an arena block header, keeping allocations aligned */
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+/* allocate zeroed size bytes from the arena */
+static void *arena_alloc(Arena *a, size_t size) {
+
+  ArenaBlock *b = a->head;
+  void *p;
+
+  size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+  // reuse a freed allocation of the same power of two size
+  if (size > 0 && (size & (size - 1)) == 0 && a->free_list[__builtin_ctzl(size)] != NULL) {
+    p = a->free_list[__builtin_ctzl(size)];
+    a->free_list[__builtin_ctzl(size)] = *(void **) p;
+    memset(p, 0x00, size);
+    return p;
+  }
+
+  if (b == NULL || b->size - b->used < size) {
+    // large allocations get a block of their own behind the current one
+    size_t block_size = (size > ARENA_BLOCK_SIZE / 4) ? size : ARENA_BLOCK_SIZE;
+
+    b = (ArenaBlock *) malloc(ARENA_HEADER + block_size);
+    if (!b)
+      return NULL;
+    b->size = block_size;
+    b->used = 0;
+    if (a->head != NULL && block_size == size) {
+      b->next = a->head->next;
+      a->head->next = b;
+    } else {
+      b->next = a->head;
+      a->head = b;
+    }
+    a->blocks++;
+    a->bytes += block_size;
+  }
+
+  p = (char *) b + ARENA_HEADER + b->used;
+  b->used += size;
+  memset(p, 0x00, size);
+
+  return p;
+}
+
+/* copy len bytes of str to a NUL terminated string in the arena */
+static char *arena_strndup(Arena *a, const char *str, size_t len) {
+
+  char *s = (char *) arena_alloc(a, len + 1);
+
+  if (s != NULL) {
+    memcpy(s, str, len);
+    s[len] = '\0';
+  }
+
+  return s;
+}
+
+/* give back an allocation of size bytes, only power of two sizes are reused */
+static void arena_free(Arena *a, void *p, size_t size) {
+
+  size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+  if (p == NULL || (size & (size - 1)) != 0) return;
+
+  *(void **) p = a->free_list[__builtin_ctzl(size)];
+  a->free_list[__builtin_ctzl(size)] = p;
+}
+
+/* move all blocks of src into dst, keeping the current block of dst */
+static void arena_adopt(Arena *dst, Arena *src) {
+
+  ArenaBlock *last;
+
+  if (src->head == NULL) return;
+
+  if (dst->head == NULL) {
+    dst->head = src->head;
+  } else {
+    for (last = src->head; last->next != NULL; last = last->next);
+    last->next = dst->head->next;
+    dst->head->next = src->head;
+  }
+  dst->blocks += src->blocks;
+  dst->bytes += src->bytes;
+  memset(src, 0x00, sizeof(Arena));
+}
+
+/* free all blocks of the arena at once */
+static void arena_release(Arena *a) {
+
+  ArenaBlock *b = a->head;
+
+  while (b != NULL) {
+    ArenaBlock *next = b->next;
+
+    free(b);
+    b = next;
+  }
+  memset(a, 0x00, sizeof(Arena));
+}
+
+/* release everything the run allocated, so another run starts clean */
+static void free_run(Sched *s) {
+
+  for (int c = 0; s->cpus != NULL && c < s->nr_cpus; c++)
+    for (int i = 0; i < 3; i++)
+      if (c == 0 || s->cpus[c].queue[i] != s->cpus[0].queue[i])
+        free(s->cpus[c].queue[i]->heap);
+
+  free(s->live_tasks.slots);
+  memset(&s->live_tasks, 0x00, sizeof(TaskIndex));
+
+  if (s->stream != NULL && s->stream != stdin)
+    fclose(s->stream);
+  s->stream = NULL;
+  free(s->stream_line);
+  s->stream_line = NULL;
+  s->stream_cap = 0;
+
+  free(s->table.remaining_time);
+  free(s->table.seq);
+  free(s->table.next);
+  free(s->table.start_time);
+  free(s->table.node);
+  if (s->workload == NULL) {				// the input columns of a clone are shared
+    free(s->table.priority);
+    free(s->table.type);
+    free(s->table.arrive_time);
+    free(s->table.service_time);
+    free(s->table.id);
+  }
+  memset(&s->table, 0x00, sizeof(TaskTable));
+
+  if (s->mapped != NULL)
+    munmap((void *) s->mapped, s->mapped_size);
+  s->mapped = NULL;
+  s->mapped_size = 0;
+
+  // tasks, ids, gantt nodes and their runs, queues and cpu
+  arena_release(&s->arena);
+
+  s->tasks = NO_TASK;
+  s->tasks_tail = NO_TASK;
+  s->gantt_list.head = NULL;
+  s->gantt_list.tail = NULL;
+  s->H_queue = NULL;
+  s->M_queue = NULL;
+  s->L_queue = NULL;
+  s->cpu = NULL;
+  s->cpus = NULL;
+  s->next_cpu = 0;
+}
+
+/* make gantt node with a task */
+static Node *add_gantt_node(Sched *s, TaskRef task) {
+
+  Node *new_node;
+
+  new_node = (Node *) arena_alloc(&s->arena, sizeof(Node));
+  if (!new_node) {
+    MSG ("failed to allocate a gantt node: %s\n", STRERROR);
+    return NULL;
+  }
+  new_node->id = s->table.id[task];
+  new_node->task = task;
+
+  if (s->gantt_list.head == NULL) {		// if gantt node list is empty
+    s->gantt_list.head = new_node;
+  } else {
+    s->gantt_list.tail->next = new_node;
+  }
+  s->gantt_list.tail = new_node;
+
+  return new_node;
+}
+
+/* record that task ran for ticks starting at start to its gantt node */
+static void record_to_gantt(Sched *s, TaskRef task, Time start, Time ticks) {
+
+  Node *n = s->table.node ? s->table.node[task] : NULL;
+
+  if (n == NULL) return;
+
+  // the task kept the cpu, extend its last run
+  if (n->run_count > 0 && n->runs[n->run_count - 1].end == start) {
+    n->runs[n->run_count - 1].end = start + ticks;
+    return;
+  }
+
+  if (n->run_count == n->run_cap) {
+    int cap = n->run_cap ? n->run_cap * 2 : 4;
+    Run *runs = (Run *) arena_alloc(&s->arena, cap * sizeof(Run));
+
+    if (!runs) {
+      MSG ("failed to grow the gantt record of %s: %s\n", n->id, STRERROR);
+      return;
+    }
+    // the outgrown runs are reused by later gantt records
+    if (n->run_count > 0)
+      memcpy(runs, n->runs, n->run_count * sizeof(Run));
+    arena_free(&s->arena, n->runs, n->run_cap * sizeof(Run));
+    n->runs = runs;
+    n->run_cap = cap;
+  }
+
+  n->runs[n->run_count].start = start;
+  n->runs[n->run_count].end = start + ticks;
+  n->run_count++;
+}
+
+/* print gantt chart */
+static void print_gantt(Sched *s, FILE *fp) {
+
+  Node *n = s->gantt_list.head;
+
+  if (n == NULL) return;
+  
+  while (n != NULL) {
+    int r = 0;
+
+    fprintf(fp, "%s ", n->id);
+    for (int i = 0; i < 60; i++) {
+      while (r < n->run_count && n->runs[r].end <= i) r++;
+      if (r < n->run_count && n->runs[r].start <= i) {
+        fprintf(fp, "*");
+      } else {
+        fprintf(fp, " ");
+      }
+    }
+    fprintf(fp, "\n");
+    n = n->next;
+  }
+}
+
+/* print per core metrics and the utilization of all cores */
+static void print_cpus(Sched *s, FILE *fp) {
+
+  Time busy = 0;
+  long migrations = 0;
+
+  fprintf(fp, "\n");
+  for (int c = 0; c < s->nr_cpus; c++) {
+    CPU *core = &s->cpus[c];
+    long done = core->completed;
+
+    fprintf(fp, "CPU %d: BUSY TIME %lld (%.2f%%), TASKS %ld, "
+            "AVERAGE TURNAROUND TIME: %.2f, AVERAGE WAITING TIME: %.2f",
+            c, core->busy, s->now ? 100.0 * core->busy / s->now : 0.0, done,
+            done ? ((double) core->turn_around_time) / done : 0.0,
+            done ? ((double) core->waiting_time) / done : 0.0);
+    if (s->stealing)
+      fprintf(fp, ", MIGRATIONS %ld", core->migrations);
+    fprintf(fp, "\n");
+    busy += core->busy;
+    migrations += core->migrations;
+  }
+  fprintf(fp, "UTILIZATION: %.2f%%\n", s->now ? 100.0 * busy / ((double) s->now * s->nr_cpus) : 0.0);
+  if (s->stealing)
+    fprintf(fp, "MIGRATIONS: %ld, PENALTY %lld TICKS EACH\n", migrations, s->migration_penalty);
+}
+
+/* histogram of one latency of the tasks of a type */
+static Histogram *get_histogram(Sched *s, Type type, Latency latency) {
+  return &s->latency[type * NR_LATENCIES + latency];
+}
+
+/* bucket of a value: its top HIST_SUB_BITS + 1 bits and their position */
+static int hist_bucket(Time val) {
+
+  int shift;
+
+  if (val < HIST_SUB_COUNT) return (val < 0) ? 0 : val;
+
+  shift = 63 - __builtin_clzll(val) - HIST_SUB_BITS;
+  return ((shift + 1) << HIST_SUB_BITS) + (int) (val >> shift) - HIST_SUB_COUNT;
+}
+
+/* largest value of a bucket */
+static Time hist_value(int bucket) {
+
+  int shift = (bucket >> HIST_SUB_BITS) - 1;
+
+  if (shift < 0) return bucket;
+
+  return (((Time) (bucket & (HIST_SUB_COUNT - 1)) + HIST_SUB_COUNT) << shift)
+         + ((Time) 1 << shift) - 1;
+}
+
+/* count a value */
+static void hist_record(Histogram *h, Time val) {
+
+  h->bucket[hist_bucket(val)]++;
+  h->count++;
+  if (val > h->max)
+    h->max = val;
+}
+
+/* add the values of src to dst */
+static void hist_merge(Histogram *dst, const Histogram *src) {
+
+  for (int i = 0; i < HIST_BUCKETS; i++)
+    dst->bucket[i] += src->bucket[i];
+  dst->count += src->count;
+  if (src->max > dst->max)
+    dst->max = src->max;
+}
+
+/* smallest value at least q of the values are not above, to the bucket width */
+static Time hist_percentile(const Histogram *h, double q) {
+
+  uint64_t rank = (uint64_t) ceil(q * h->count);
+  uint64_t seen = 0;
+
+  if (h->count == 0) return 0;
+  if (rank < 1) rank = 1;
+
+  for (int i = 0; i < HIST_BUCKETS; i++) {
+    seen += h->bucket[i];
+    if (seen >= rank)
+      return (hist_value(i) < h->max) ? hist_value(i) : h->max;
+  }
+
+  return h->max;
+}
+
+/* print the latency percentiles of each type and of all tasks */
+static void print_latency(Sched *s, FILE *fp) {
+
+  static const char *types[] = { "H", "M", "L", "ALL" };
+  static const char *latencies[] = { "TURNAROUND", "WAITING", "RESPONSE" };
+  const TimeSum *sums[] = { s->turn_around_time, s->waiting_time, s->response_time };
+  Histogram *all = (Histogram *) calloc(NR_LATENCIES, sizeof(Histogram));
+
+  if (!all) {
+    MSG ("failed to allocate the latency histograms: %s\n", STRERROR);
+    return;
+  }
+  for (Type type = H; type <= L; type++)
+    for (int l = 0; l < NR_LATENCIES; l++)
+      hist_merge(&all[l], get_histogram(s, type, l));
+
+  fprintf(fp, "\n[Latency Percentiles]\n");
+  fprintf(fp, "%-5s %-10s %10s %14s %12s %12s %12s %12s %12s\n", "TYPE", "LATENCY", "TASKS",
+          "AVERAGE", "P50", "P90", "P99", "P99.9", "MAX");
+  for (int type = H; type <= L + 1; type++) {
+    for (int l = 0; l < NR_LATENCIES; l++) {
+      Histogram *h = (type > L) ? &all[l] : get_histogram(s, type, l);
+      TimeSum sum = (type > L) ? sums[l][H] + sums[l][M] + sums[l][L] : sums[l][type];
+
+      if (h->count == 0) continue;
+      fprintf(fp, "%-5s %-10s %10ld %14.2f %12lld %12lld %12lld %12lld %12lld\n", types[type],
+              latencies[l], h->count, ((double) sum) / h->count, hist_percentile(h, 0.5),
+              hist_percentile(h, 0.9), hist_percentile(h, 0.99), hist_percentile(h, 0.999), h->max);
+    }
+  }
+
+  free(all);
+}
+
+/* cycle counter of the phase timing, nanoseconds where there is no rdtsc */
+static inline uint64_t prof_clock() {
+#ifdef HAVE_X86_SIMD
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/* print the hot path counters and the share of each phase */
+static void print_profile(Sched *s, FILE *fp) {
+
+  static const char *phases[NR_PHASES] = {
+    "read stream", "long term", "steal", "short term", "process"
+  };
+  Profile *p = &s->prof;
+  uint64_t total = 0;
+
+  for (int i = 0; i < NR_PHASES; i++)
+    total += p->cycles[i];
+
+  fprintf(fp, "\n[Profile]\n");
+  fprintf(fp, "STEPS: %ld\n", p->steps);
+  fprintf(fp, "CONTEXT SWITCHES: %ld\n", p->context_switches);
+  fprintf(fp, "PREEMPTIONS: %ld H BY H, %ld L BY H OR M\n", p->preempt_h, p->preempt_l);
+  fprintf(fp, "QUANTUM EXPIRIES: %ld H, %ld M\n", p->expire_h, p->expire_m);
+  fprintf(fp, "ENQUEUES: %ld, M HEAP WALK AVERAGE %.2f MAX %ld\n", p->enqueues,
+          p->enqueues ? ((double) p->enqueue_walk) / p->enqueues : 0.0, p->max_enqueue_walk);
+  fprintf(fp, "IDLE CORE TICKS: %lld\n", p->idle_ticks);
+  for (int i = 0; i < NR_PHASES; i++)
+    fprintf(fp, "PHASE %-11s %14llu CYCLES %6.2f%% %10.2f PER STEP\n", phases[i],
+            (unsigned long long) p->cycles[i], total ? 100.0 * p->cycles[i] / total : 0.0,
+            p->steps ? ((double) p->cycles[i]) / p->steps : 0.0);
+}
+
+/* check id is valid, an upper case letter followed by digits */
+static int check_valid_id(const Limits *limits, const char *str, size_t len) {
+
+  if (len < 2 || len > limits->id_len)						// if ID length is invalid
+    return -1;
+
+  if (!isupper((unsigned char) str[0]))					// if ID is over ranged
+    return -1;
+
+  for (size_t i = 1; i < len; i++) {
+    if (!isdigit((unsigned char) str[i]))
+      return -1;
+  }
+
+  return 0;
+}
+
+/* number of decimal digits of a limit */
+static size_t count_digits(Time val) {
+
+  size_t len = 1;
+
+  while (val >= 10) {
+    val /= 10;
+    len++;
+  }
+
+  return len;
+}
+
+/* FNV-1a hash of a task id */
+static unsigned long hash_id(const char *id, size_t len) {
+
+  unsigned long h = 14695981039346656037UL;
+
+  for (size_t i = 0; i < len; i++) {
+    h ^= (unsigned char) id[i];
+    h *= 1099511628211UL;
+  }
+
+  return h;
+}
+
+/* look up task id is existed */
+static const char *lookup_id (TaskIndex *index, const char *id, size_t len, unsigned long h) {
+
+  size_t i;
+
+  if (index->slots == NULL) return NULL;
+
+  // linear probing until the id or an empty slot
+  for (i = h & (index->cap - 1); index->slots[i].id != NULL;
+       i = (i + 1) & (index->cap - 1)) {
+    const char *s = index->slots[i].id;
+
+    if (index->slots[i].hash == h && !strncmp (s, id, len) && s[len] == '\0')
+      return s;
+  }
+
+  return NULL;
+}
+
+/* add task id with hash h to the index, growing it at half load */
+static int index_id(TaskIndex *index, const char *id, unsigned long h) {
+
+  size_t i;
+
+  if ((index->count + 1) * 2 > index->cap) {
+    size_t old_cap = index->cap;
+    IndexSlot *old_slots = index->slots;
+    size_t cap = old_cap ? old_cap * 2 : 1024;
+
+    index->slots = (IndexSlot *) calloc(cap, sizeof(IndexSlot));
+    if (!index->slots) {
+      MSG ("failed to grow the task index: %s\n", STRERROR);
+      index->slots = old_slots;
+      return -1;
+    }
+    index->cap = cap;
+
+    // rehash the old slots
+    for (size_t j = 0; j < old_cap; j++) {
+      if (old_slots[j].id == NULL) continue;
+      for (i = old_slots[j].hash & (cap - 1); index->slots[i].id != NULL;
+           i = (i + 1) & (cap - 1));
+      index->slots[i] = old_slots[j];
+    }
+    free(old_slots);
+  }
+
+  for (i = h & (index->cap - 1); index->slots[i].id != NULL;
+       i = (i + 1) & (index->cap - 1));
+  index->slots[i].hash = h;
+  index->slots[i].id = id;
+  index->count++;
+
+  return 0;
+}
+
+/* remove task id with hash h from the index, the same string that was added */
+static void unindex_id(TaskIndex *index, const char *id, unsigned long h) {
+
+  size_t mask = index->cap - 1;
+  size_t i;
+  size_t j;
+
+  if (index->slots == NULL) return;
+
+  for (i = h & mask; index->slots[i].id != id; i = (i + 1) & mask)
+    if (index->slots[i].id == NULL) return;
+  index->slots[i].id = NULL;
+  index->count--;
+
+  // shift back the following slots whose probe passed the freed one
+  for (j = (i + 1) & mask; index->slots[j].id != NULL; j = (j + 1) & mask) {
+    size_t home = index->slots[j].hash & mask;
+
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      index->slots[i] = index->slots[j];
+      index->slots[j].id = NULL;
+      i = j;
+    }
+  }
+}
+
+/* convert a run of digits to its value */
+static int parse_digits_scalar(const char *str, size_t len, Time *val) {
+
+  Time v = 0;
+
+  for (size_t i = 0; i < len; i++) {
+    if (!isdigit((unsigned char) str[i]))		// if it is not digit value
+      return -1;
+    v = v * 10 + (str[i] - '0');
+  }
+
+  *val = v;
+  return 0;
+}
+
+/* find the first nr spaces of a line, returns how many there are */
+static int find_spaces_scalar(const char *line, size_t len, const char **space, int nr) {
+
+  const char *end = line + len;
+  const char *p = line;
+  int found = 0;
+
+  while (found < nr && (p = memchr (p, ' ', end - p)) != NULL)
+    space[found++] = p++;
+
+  return found;
+}
+
+#ifdef HAVE_X86_SIMD
+
+/* true when n bytes from p stay in one page, so reading them cannot fault */
+#define LOAD_IN_PAGE(p, n) \
+  ((((uintptr_t) (p)) & (PAGE_SIZE_MIN - 1)) <= PAGE_SIZE_MIN - (n))
+
+/* convert up to 16 digits with one compare and a multiply-add ladder */
+__attribute__((target("sse4.1")))
+static int parse_digits_sse41(const char *str, size_t len, Time *val) {
+
+  __m128i d;
+  __m128i t;
+  unsigned int digits;
+
+  if (len > 16 || !LOAD_IN_PAGE(str, 16))
+    return parse_digits_scalar(str, len, val);
+
+  // every byte of the field must be 0..9 after subtracting '0'
+  d = _mm_sub_epi8 (_mm_loadu_si128 ((const __m128i *) str), _mm_set1_epi8 ('0'));
+  digits = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_max_epu8 (d, _mm_set1_epi8 (9)),
+                                               _mm_set1_epi8 (9)));
+  if ((digits & ((1u << len) - 1)) != (1u << len) - 1)
+    return -1;
+
+  // 16 digits -> 8 x 2 -> 4 x 4 -> 2 x 8
+  d = _mm_shuffle_epi8 (d, _mm_loadu_si128 ((const __m128i *) digit_align[len]));
+  t = _mm_maddubs_epi16 (d, _mm_setr_epi8 (10, 1, 10, 1, 10, 1, 10, 1,
+                                           10, 1, 10, 1, 10, 1, 10, 1));
+  t = _mm_madd_epi16 (t, _mm_setr_epi16 (100, 1, 100, 1, 100, 1, 100, 1));
+  t = _mm_packus_epi32 (t, t);
+  t = _mm_madd_epi16 (t, _mm_setr_epi16 (10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+  *val = (Time) (uint32_t) _mm_cvtsi128_si32 (t) * 100000000
+         + (uint32_t) _mm_extract_epi32 (t, 1);
+  return 0;
+}
+
+/* find the first nr spaces of a line, 16 bytes per compare */
+static int find_spaces_sse2(const char *line, size_t len, const char **space, int nr) {
+
+  int found = 0;
+  size_t off;
+
+  for (off = 0; off < len && found < nr; off += 16) {
+    unsigned int mask;
+
+    if (off + 16 > len && !LOAD_IN_PAGE(line + off, 16))
+      return found + find_spaces_scalar (line + off, len - off, space + found, nr - found);
+
+    mask = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (line + off)),
+                                              _mm_set1_epi8 (' ')));
+    if (off + 16 > len)
+      mask &= (1u << (len - off)) - 1;
+    for (; mask && found < nr; mask &= mask - 1)
+      space[found++] = line + off + __builtin_ctz (mask);
+  }
+
+  return found;
+}
+
+/* find the first nr spaces of a line, 32 bytes per compare */
+__attribute__((target("avx2")))
+static int find_spaces_avx2(const char *line, size_t len, const char **space, int nr) {
+
+  int found = 0;
+  size_t off;
+
+  for (off = 0; off < len && found < nr; off += 32) {
+    unsigned int mask;
+
+    if (off + 32 > len && !LOAD_IN_PAGE(line + off, 32))
+      return found + find_spaces_sse2 (line + off, len - off, space + found, nr - found);
+
+    mask = _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const __m256i *) (line + off)),
+                                                    _mm256_set1_epi8 (' ')));
+    if (off + 32 > len)
+      mask &= (1u << (len - off)) - 1;
+    for (; mask && found < nr; mask &= mask - 1)
+      space[found++] = line + off + __builtin_ctz (mask);
+  }
+
+  return found;
+}
+
+#endif
+
+/* pick the widest tokenizer and digit converter this cpu runs */
+static void init_simd() {
+
+#ifdef HAVE_X86_SIMD
+  // shuffle masks which right align len digits and zero the rest, built
+  // once here before any parser thread can use them
+  for (int l = 0; l <= 16; l++)
+    for (int i = 0; i < 16; i++)
+      digit_align[l][i] = (i < 16 - l) ? -128 : i - (16 - l);
+
+  __builtin_cpu_init ();
+  find_spaces = __builtin_cpu_supports ("avx2") ? find_spaces_avx2 : find_spaces_sse2;
+  if (__builtin_cpu_supports ("sse4.1"))
+    parse_digits = parse_digits_sse41;
+#endif
+}
+
+/* check arrive time is valid */
+static int check_valid_arrive_time(const Limits *limits, const char *str, size_t len, Time *val) {
+
+  if (len > count_digits(limits->max_arrive_time))		// if time length is invalid
+    return -1;
+
+  if (parse_digits(str, len, val))									// if it is not digit values
+    return -1;
+
+  if (*val < MIN_ARRIVE_TIME || *val > limits->max_arrive_time)	// if it is over ranged
+    return -1;
+
+  return 0;
+}
+
+/* check service time is valid */
+static int check_valid_service_time(const Limits *limits, const char *str, size_t len, Time *val) {
+
+  if (len > count_digits(limits->max_service_time))	// if its length is invalid
+    return -1;
+
+  if (parse_digits(str, len, val))									// if it is not digit value
+    return -1;
+
+  if (*val < MIN_SERVICE_TIME || *val > limits->max_service_time)	// if it is over ranged
+    return -1;
+
+  return 0;
+}
+
+/* check priority is valid */
+static int check_valid_priority(const char *str, size_t len, int *val) {
+
+  Time v;
+
+  if (len > PRIORITY_LEN)									// if its length is invalid
+    return -1;
+
+  if (parse_digits(str, len, &v))					// if it is not digit value
+    return -1;
+
+  if (v < MIN_PRIORITY || v > MAX_PRIORITY)   // if it is over ranged
+    return -1;
+
+  *val = (int) v;
+  return 0;
+}
+
+/* strip white spaces around a field of len bytes */
+static const char *strstrip (const char *str, size_t *len) {
+
+  while (*len > 0 && isspace ((unsigned char) str[*len - 1]))
+    (*len)--;
+
+  while (*len > 0 && isspace ((unsigned char) *str)) {
+    str++;
+    (*len)--;
+  }
+
+  return str;
+}
+
+/* grow every column of the task table to cap slots */
+static int grow_table(Sched *s, TaskRef cap) {
+
+#define GROW_COLUMN(col) do {																\
+    void *p = realloc(s->table.col, (size_t) cap * sizeof(*s->table.col));	\
+    if (!p) goto fail;																			\
+    s->table.col = p;																					\
+  } while (0)
+
+  if (cap <= s->table.cap) return 0;
+
+  GROW_COLUMN(remaining_time);
+  GROW_COLUMN(seq);
+  GROW_COLUMN(priority);
+  GROW_COLUMN(type);
+  GROW_COLUMN(next);
+  GROW_COLUMN(arrive_time);
+  GROW_COLUMN(service_time);
+  GROW_COLUMN(start_time);
+  GROW_COLUMN(id);
+  GROW_COLUMN(node);
+  s->table.cap = cap;
+
+  return 0;
+
+fail:
+  MSG ("failed to grow the task table to %u tasks: %s\n", cap, STRERROR);
+  return -1;
+
+#undef GROW_COLUMN
+}
+
+/* append a parsed task to the task table and tasks list */
+static TaskRef append_task(Sched *s, Task *new_task) {
+
+  TaskRef t;
+
+  if (s->table.nr_free > 0) {						// reuse a released slot
+    t = s->table.free;
+    s->table.free = s->table.next[t];
+    s->table.nr_free--;
+  } else {
+    if (s->table.count == s->table.cap) {
+      TaskRef cap = (s->table.cap == 0) ? TASK_TABLE_MIN
+                  : (s->table.cap < NO_TASK / 2) ? s->table.cap * 2 : NO_TASK;
+
+      if (cap == s->table.cap) {
+        MSG ("too many tasks for the task table\n");
+        return NO_TASK;
+      }
+      if (grow_table(s, cap))
+        return NO_TASK;
+    }
+    t = s->table.count++;
+  }
+
+  s->table.remaining_time[t] = new_task->service_time;
+  s->table.seq[t] = 0;
+  s->table.priority[t] = new_task->priority;
+  s->table.type[t] = new_task->type;
+  s->table.next[t] = NO_TASK;
+  s->table.arrive_time[t] = new_task->arrive_time;
+  s->table.service_time[t] = new_task->service_time;
+  s->table.start_time[t] = 0;
+  s->table.id[t] = new_task->id;
+
+  if (s->tasks == NO_TASK) {
+    s->tasks = t;
+  } else {
+    s->table.next[s->tasks_tail] = t;
+  }
+  s->tasks_tail = t;
+
+  if (DEBUG)
+    MSG ("id:%s type:%d arrive-time:%lld service-time:%lld priority:%d\n",
+        new_task->id, new_task->type, new_task->arrive_time,
+        new_task->service_time, new_task->priority);
+
+  // streamed tasks are reported as they finish, not charted
+  s->table.node[t] = s->streaming ? NULL : add_gantt_node(s, t);
+
+  return t;
+}
+
+/* give the slot of a finished task back for later streamed tasks */
+static void release_task(Sched *s, TaskRef t) {
+
+  s->table.id[t] = NULL;
+  s->table.next[t] = s->table.free;
+  s->table.free = t;
+  s->table.nr_free++;
+}
+
+/* stable merge sort of a task list by arrive time */
+static TaskRef sort_tasks(Sched *s, TaskRef list) {
+
+  struct { Time key; TaskRef task; } *a, *b, *tmp;
+  size_t n = 0;
+  bool sorted = true;
+  TaskRef t;
+
+  for (t = list; t != NO_TASK; t = s->table.next[t]) {
+    if (s->table.next[t] != NO_TASK && s->table.arrive_time[s->table.next[t]] < s->table.arrive_time[t])
+      sorted = false;
+    n++;
+  }
+  if (sorted) return list;						// workloads are usually in order
+
+  // sort (key, task) pairs instead of chasing the list
+  a = malloc(n * sizeof(*a));
+  b = malloc(n * sizeof(*b));
+  if (!a || !b) {
+    MSG ("failed to sort tasks: %s\n", STRERROR);
+    free(a);
+    free(b);
+    return list;
+  }
+  n = 0;
+  for (t = list; t != NO_TASK; t = s->table.next[t]) {
+    a[n].key = s->table.arrive_time[t];
+    a[n].task = t;
+    n++;
+  }
+
+  // bottom-up merge, taking from the left run on ties to keep input order
+  for (size_t width = 1; width < n; width *= 2) {
+    for (size_t lo = 0; lo < n; lo += 2 * width) {
+      size_t mid = (lo + width < n) ? lo + width : n;
+      size_t hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+      size_t i = lo, j = mid, k = lo;
+
+      while (i < mid && j < hi)
+        b[k++] = (a[j].key < a[i].key) ? a[j++] : a[i++];
+      while (i < mid) b[k++] = a[i++];
+      while (j < hi) b[k++] = a[j++];
+    }
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  for (size_t i = 0; i + 1 < n; i++)
+    s->table.next[a[i].task] = a[i + 1].task;
+  s->table.next[a[n - 1].task] = NO_TASK;
+  list = a[0].task;
+
+  free(a);
+  free(b);
+
+  return list;
+}
+
+/* parse the fields of one line into task, id and the offending field */
+static LineStatus parse_line(const Limits *limits, const char *line, size_t len,
+                             Task *task, Slice *id, Slice *field) {
+
+  const char *end = line + len;
+  const char *space[4];
+  int nr_spaces;
+  const char *s;
+  const char *p;
+  size_t n;
+
+  memset(task, 0x00, sizeof(Task));
+  id->str = NULL;
+  id->len = 0;
+  field->str = NULL;
+  field->len = 0;
+
+  /* comment or empty line */
+  if (len == 0 || line[0] == '#')
+    return LINE_SKIP;
+
+  /* the first four spaces split the five fields */
+  nr_spaces = find_spaces (line, len, space, 4);
+
+  /* id */
+  s = line;
+  if (nr_spaces < 1)
+    return LINE_INVALID_FORMAT;
+  p = space[0];
+  n = p - s;
+  field->str = strstrip (s, &n);
+  field->len = n;
+  if (check_valid_id (limits, field->str, field->len))
+    return LINE_INVALID_ID;
+
+  *id = *field;												// duplicates are checked by the caller
+
+  /* process-type */
+  s = p + 1;
+  if (nr_spaces < 2)
+    return LINE_INVALID_FORMAT;
+  p = space[1];
+  n = p - s;
+  field->str = strstrip (s, &n);
+  field->len = n;
+
+  if (n == 1 && toupper ((unsigned char) field->str[0]) == 'H') {
+    task->type = H;
+  }
+  else if (n == 1 && toupper ((unsigned char) field->str[0]) == 'M') {
+    task->type = M;
+  }
+  else if (n == 1 && toupper ((unsigned char) field->str[0]) == 'L') {
+    task->type = L;
+  }
+  else
+    return LINE_INVALID_ACTION;
+
+  /* arrive-time */
+  s = p + 1;
+  if (nr_spaces < 3)
+    return LINE_INVALID_FORMAT;
+  p = space[2];
+  n = p - s;
+  field->str = strstrip (s, &n);
+  field->len = n;
+  if (check_valid_arrive_time (limits, field->str, field->len, &task->arrive_time))
+    return LINE_INVALID_ARRIVE_TIME;
+
+  /* service-time */
+  s = p + 1;
+  if (nr_spaces < 4)
+    return LINE_INVALID_FORMAT;
+  p = space[3];
+  n = p - s;
+  field->str = strstrip (s, &n);
+  field->len = n;
+  if (check_valid_service_time (limits, field->str, field->len, &task->service_time))
+    return LINE_INVALID_SERVICE_TIME;
+
+  /* priority */
+  s = p + 1;
+  n = end - s;
+  field->str = strstrip (s, &n);
+  field->len = n;
+  if (n == 0)
+    return LINE_EMPTY_PRIORITY;
+  if (check_valid_priority (field->str, field->len, &task->priority))
+    return LINE_INVALID_PRIORITY;
+
+  return LINE_TASK;
+}
+
+/* print the diagnostic of an ignored line */
+static void report_line(Sched *s, ParsedLine *pl) {
+
+  Task task;
+  Slice id;
+  Slice f;
+
+  parse_line (&s->limits, pl->line, pl->len, &task, &id, &f);	// find the offending field again
+  s->ignored++;
+
+  switch (pl->status) {
+    case LINE_INVALID_FORMAT:
+      ERR (s, "invalid format in line %d, ignored\n", pl->line_nr);
+      break;
+    case LINE_INVALID_ID:
+      ERR (s, "invalid id '%.*s' in line %d, ignored\n", (int) f.len, f.str, pl->line_nr);
+      break;
+    case LINE_DUPLICATE_ID:
+      ERR (s, "duplicate id '%.*s' in line %d, ignored\n", (int) id.len, id.str, pl->line_nr);
+      break;
+    case LINE_INVALID_ACTION:
+      ERR (s, "invalid action '%.*s' in line %d, ignored\n", (int) f.len, f.str, pl->line_nr);
+      break;
+    case LINE_INVALID_ARRIVE_TIME:
+      ERR (s, "invalid arrive_time '%.*s' in line %d, ignored\n", (int) f.len, f.str, pl->line_nr);
+      break;
+    case LINE_INVALID_SERVICE_TIME:
+      ERR (s, "invalid service_time '%.*s' in line %d, ignored\n", (int) f.len, f.str, pl->line_nr);
+      break;
+    case LINE_EMPTY_PRIORITY:
+      ERR (s, "empty priority in line %d, ignored\n", pl->line_nr);
+      break;
+    case LINE_INVALID_PRIORITY:
+      ERR (s, "invalid priority '%.*s' in line %d, ignored\n", (int) f.len, f.str, pl->line_nr);
+      break;
+    case LINE_NO_MEMORY:
+      ERR (s, "failed to allocate a task in line %d: %s\n", pl->line_nr, strerror (ENOMEM));
+      break;
+    default:
+      break;
+  }
+}
+
+/* parser thread: parse whole chunks into their parsed lines */
+static void *parse_chunks(void *arg) {
+
+  ParseJob *job = arg;
+  int c;
+
+  while ((c = __atomic_fetch_add (&job->next, 1, __ATOMIC_RELAXED)) < job->nr_chunks) {
+    Chunk *chunk = &job->chunks[c];
+    const char *line;
+    const char *eol;
+
+    for (int i = 0; i < job->nr_shards; i++)
+      chunk->shard_head[i] = chunk->shard_tail[i] = -1;
+
+    for (line = chunk->start; line < chunk->end; line = eol + 1) {
+      ParsedLine *pl;
+      Task task;
+      Slice id;
+      Slice field;
+      LineStatus status;
+
+      eol = memchr (line, '\n', chunk->end - line);
+      if (!eol)
+        eol = chunk->end;
+      chunk->lines++;
+
+      status = parse_line (job->limits, line, eol - line, &task, &id, &field);
+      if (status == LINE_SKIP)
+        continue;
+
+      if (chunk->count == chunk->cap) {
+        size_t cap = chunk->cap ? chunk->cap * 2 : 1024;
+        ParsedLine *parsed = realloc (chunk->parsed, cap * sizeof(ParsedLine));
+
+        if (!parsed) {
+          MSG ("failed to parse line %d of a chunk: %s\n", chunk->lines, STRERROR);
+          continue;
+        }
+        chunk->parsed = parsed;
+        chunk->cap = cap;
+      }
+
+      pl = &chunk->parsed[chunk->count++];
+      pl->line = line;
+      pl->len = eol - line;
+      pl->line_nr = chunk->lines;
+      pl->status = status;
+      pl->id = id.str;
+      pl->id_len = id.len;
+      pl->hash = id.str ? hash_id (id.str, id.len) : 0;
+      pl->task = task;
+      pl->shard_next = -1;
+
+      // chain the line into its id shard, shards take the top hash bits
+      if (id.str) {
+        int shard = (pl->hash >> 40) % job->nr_shards;
+
+        if (chunk->shard_tail[shard] < 0)
+          chunk->shard_head[shard] = chunk->count - 1;
+        else
+          chunk->parsed[chunk->shard_tail[shard]].shard_next = chunk->count - 1;
+        chunk->shard_tail[shard] = chunk->count - 1;
+      }
+
+      // each parser thread copies ids to the arena of its chunk
+      if (status == LINE_TASK
+          && !(pl->task.id = arena_strndup (&chunk->arena, id.str, id.len)))
+        pl->status = LINE_NO_MEMORY;
+    }
+  }
+
+  return NULL;
+}
+
+/* duplicate thread: check the ids of whole hash partitions in line order */
+static void *find_duplicates(void *arg) {
+
+  ParseJob *job = arg;
+  int shard;
+
+  while ((shard = __atomic_fetch_add (&job->next, 1, __ATOMIC_RELAXED)) < job->nr_shards) {
+    TaskIndex index = { NULL, 0, 0 };
+
+    for (int c = 0; c < job->nr_chunks; c++) {
+      Chunk *chunk = &job->chunks[c];
+
+      for (int i = chunk->shard_head[shard]; i >= 0; i = chunk->parsed[i].shard_next) {
+        ParsedLine *pl = &chunk->parsed[i];
+
+        // an id is taken by the first valid line which has it
+        if (lookup_id (&index, pl->id, pl->id_len, pl->hash))
+          pl->status = LINE_DUPLICATE_ID;
+        else if (pl->status == LINE_TASK && index_id (&index, pl->task.id, pl->hash))
+          pl->status = LINE_NO_MEMORY;
+      }
+    }
+
+    free (index.slots);
+  }
+
+  return NULL;
+}
+
+/* run fn on nr threads, on the calling thread alone when nr is 1 */
+static void run_parallel(int nr, void *(*fn)(void *), void *arg) {
+
+  pthread_t threads[nr];
+  int started = 0;
+
+  for (int i = 1; i < nr; i++) {
+    if (pthread_create (&threads[started], NULL, fn, arg)) {
+      MSG ("failed to start a worker thread: %s\n", STRERROR);
+      break;
+    }
+    started++;
+  }
+
+  fn (arg);
+
+  for (int i = 0; i < started; i++)
+    pthread_join (threads[i], NULL);
+}
+
+/* parsing data file, mapped and split into chunks parsed in parallel */
+static int read_config(Sched *s, const char* filename) {
+
+  int fd;
+  int err;
+  struct stat st;
+  const char *buf = NULL;
+  ParseJob job;
+  int nr_threads;
+  int line_nr = 0;
+  size_t total = 0;
+
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  if (fstat (fd, &st) < 0)
+    goto fail;
+
+  s->tasks = NO_TASK;
+  s->tasks_tail = NO_TASK;
+
+  if (st.st_size == 0) {
+    close (fd);
+    return 0;
+  }
+
+  buf = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (buf == MAP_FAILED)
+    goto fail;
+  madvise ((void *) buf, st.st_size, MADV_SEQUENTIAL);
+
+  /* binary workload, the mapping stays for the ids */
+  if (st.st_size >= sizeof(BinaryHeader) && !memcmp (buf, BINARY_MAGIC, 8)) {
+    if (load_binary (s, buf, st.st_size, filename)) {
+      errno = EINVAL;
+      goto fail;
+    }
+    close (fd);
+    s->mapped = buf;													// unmapped by free_run(s)
+    s->mapped_size = st.st_size;
+    s->tasks = sort_tasks(s, s->tasks);
+    s->tasks_tail = NO_TASK;
+    return 0;
+  }
+
+  /* split the file at newlines, small files go in one chunk */
+  nr_threads = (st.st_size < PARALLEL_PARSE_SIZE) ? 1 : s->parse_threads;
+  memset (&job, 0x00, sizeof(job));
+  job.limits = &s->limits;
+  job.nr_chunks = (nr_threads == 1) ? 1 : nr_threads * CHUNKS_PER_THREAD;
+  job.nr_shards = nr_threads;
+  job.chunks = calloc (job.nr_chunks, sizeof(Chunk));
+  if (!job.chunks)
+    goto fail;
+
+  for (int c = 0; c < job.nr_chunks; c++) {
+    const char *end = buf + st.st_size;
+    const char *split = buf + (size_t) st.st_size * (c + 1) / job.nr_chunks;
+
+    if (split < end && (split = memchr (split, '\n', end - split)))
+      split++;
+    else
+      split = end;
+    if (c > 0 && split < job.chunks[c - 1].end)
+      split = job.chunks[c - 1].end;
+
+    job.chunks[c].start = (c > 0) ? job.chunks[c - 1].end : buf;
+    job.chunks[c].end = split;
+  }
+
+  /* parse all chunks, then check ids partitioned by hash */
+  run_parallel (nr_threads, parse_chunks, &job);
+  job.next = 0;
+  run_parallel (nr_threads, find_duplicates, &job);
+
+  /* append tasks and report ignored lines in line order */
+  for (int c = 0; c < job.nr_chunks; c++)
+    total += job.chunks[c].count;
+  if (total > 0 && total < NO_TASK)
+    grow_table (s, total);									// otherwise append_task(s) grows it
+
+  for (int c = 0; c < job.nr_chunks; c++) {
+    Chunk *chunk = &job.chunks[c];
+
+    for (size_t i = 0; i < chunk->count; i++) {
+      ParsedLine *pl = &chunk->parsed[i];
+
+      pl->line_nr += line_nr;
+      if (pl->status == LINE_TASK)
+        append_task (s, &pl->task);
+      else
+        report_line (s, pl);
+    }
+    line_nr += chunk->lines;
+    free (chunk->parsed);
+    arena_adopt (&s->arena, &chunk->arena);
+  }
+  free (job.chunks);
+
+  munmap ((void *) buf, st.st_size);
+  close (fd);
+
+  /* pending tasks are admitted from the head in order of arrival */
+  s->tasks = sort_tasks(s, s->tasks);
+  s->tasks_tail = NO_TASK;
+
+  return 0;
+
+fail:
+  err = errno;
+  if (buf != NULL && buf != MAP_FAILED)
+    munmap ((void *) buf, st.st_size);
+  close (fd);
+  errno = err;
+  return -1;
+}
+
+/* stream task lines from stdin ("-") or a file which is not regular, such as a FIFO */
+static int open_stream(Sched *s, const char *filename) {
+
+  struct stat st;
+
+  if (!strcmp (filename, "-")) {
+    s->stream = stdin;
+  } else {
+    if (stat (filename, &st) < 0 || S_ISREG (st.st_mode))
+      return 0;												// loaded whole by read_config(s)
+    s->stream = fopen (filename, "r");
+    if (!s->stream)
+      return -1;
+  }
+
+  s->streaming = true;
+  s->tasks = NO_TASK;
+  s->tasks_tail = NO_TASK;
+
+  return 0;
+}
+
+/* read streamed lines until a pending task arrives after now or the stream ends */
+static void read_stream(Sched *s) {
+
+  ssize_t len;
+
+  // the pending tail bounds the next arrival, lines come in arrival order
+  while (s->stream && (s->tasks == NO_TASK || s->table.arrive_time[s->tasks_tail] <= s->now)) {
+    ParsedLine pl;
+    Task task;
+    Slice id;
+    Slice field;
+
+    len = getline (&s->stream_line, &s->stream_cap, s->stream);
+    if (len < 0) {
+      if (ferror (s->stream))
+        ERR (s, "failed to read streamed line %d: %s\n", s->stream_line_nr + 1, STRERROR);
+      if (s->stream != stdin)
+        fclose (s->stream);
+      s->stream = NULL;
+      free (s->stream_line);
+      s->stream_line = NULL;
+      s->stream_cap = 0;
+      break;
+    }
+    s->stream_line_nr++;
+    if (len > 0 && s->stream_line[len - 1] == '\n')
+      len--;
+
+    memset (&pl, 0x00, sizeof(pl));
+    pl.line = s->stream_line;
+    pl.len = len;
+    pl.line_nr = s->stream_line_nr;
+    pl.status = parse_line (&s->limits, s->stream_line, len, &task, &id, &field);
+    if (pl.status == LINE_SKIP)
+      continue;
+
+    // ids only have to be unique among the tasks which are not done, a
+    // taken id is reported before the other fields as in a whole file
+    if (id.str) {
+      pl.hash = hash_id (id.str, id.len);
+      if (lookup_id (&s->live_tasks, id.str, id.len, pl.hash))
+        pl.status = LINE_DUPLICATE_ID;
+    }
+
+    if (pl.status == LINE_TASK && s->tasks != NO_TASK
+        && task.arrive_time < s->table.arrive_time[s->tasks_tail]) {
+      ERR (s, "arrive_time '%lld' in line %d is before the previous task's, ignored\n",
+           task.arrive_time, s->stream_line_nr);
+      s->ignored++;
+      continue;
+    }
+
+    // streamed ids are freed with their finished task
+    if (pl.status == LINE_TASK) {
+      task.id = strndup (id.str, id.len);
+      if (!task.id || index_id (&s->live_tasks, task.id, pl.hash)) {
+        free (task.id);
+        pl.status = LINE_NO_MEMORY;
+      } else if (append_task (s, &task) == NO_TASK) {
+        unindex_id (&s->live_tasks, task.id, pl.hash);
+        free (task.id);
+      }
+    }
+
+    if (pl.status != LINE_TASK)
+      report_line (s, &pl);
+  }
+}
+
+/* emit a streamed task which completed at complete_time and release it */
+static void finish_task(Sched *s, TaskRef task, Time complete_time) {
+
+  char *id = s->table.id[task];
+  Time turn_around_time = complete_time - s->table.arrive_time[task];
+  Time waiting_time = turn_around_time - s->table.service_time[task];
+
+  fprintf(s->out, "%s done at %lld, turnaround %lld, waiting %lld\n", id,
+          complete_time, turn_around_time, waiting_time);
+
+  unindex_id (&s->live_tasks, id, hash_id (id, strlen (id)));
+  free (id);
+  release_task (s, task);
+}
+
+/* checksum of the whole 8 byte words of buf, chained through h */
+static unsigned long checksum(const void *buf, size_t len, unsigned long h) {
+
+  const uint64_t *w = buf;
+
+  for (size_t i = 0; i < len / 8; i++)
+    h = (h ^ w[i]) * 1099511628211UL;
+
+  return h;
+}
+
+/* offsets of the columns after the header, offset[NR_COLUMNS] is the end */
+static void binary_layout(uint64_t count, uint64_t id_bytes, uint64_t *offset) {
+
+  uint64_t size[NR_COLUMNS];
+
+  size[COL_ARRIVE_TIME] = count * sizeof(int64_t);
+  size[COL_SERVICE_TIME] = count * sizeof(int64_t);
+  size[COL_ID_OFFSET] = count * sizeof(uint64_t);
+  size[COL_TYPE] = count;
+  size[COL_PRIORITY] = count;
+  size[COL_ID] = id_bytes;
+
+  offset[0] = 0;
+  for (int c = 0; c < NR_COLUMNS; c++)
+    offset[c + 1] = offset[c] + ((size[c] + 7) & ~(uint64_t) 7);
+}
+
+/* write the parsed tasks in input order as a binary workload */
+static int write_binary(Sched *s, const char *filename) {
+
+  BinaryHeader hdr;
+  uint64_t offset[NR_COLUMNS + 1];
+  char *payload;
+  int64_t *arrive_time;
+  int64_t *service_time;
+  uint64_t *id_offset;
+  uint8_t *type;
+  uint8_t *priority;
+  char *ids;
+  uint64_t i = 0;
+  uint64_t id_pos = 0;
+  FILE *fp;
+  int err;
+
+  memset (&hdr, 0x00, sizeof(hdr));
+  memcpy (hdr.magic, BINARY_MAGIC, 8);
+  hdr.version = BINARY_VERSION;
+  hdr.header_size = sizeof(hdr);
+  for (Node *n = s->gantt_list.head; n != NULL; n = n->next) {
+    hdr.count++;
+    hdr.id_bytes += strlen (n->id) + 1;
+  }
+
+  binary_layout (hdr.count, hdr.id_bytes, offset);
+  payload = calloc (1, offset[NR_COLUMNS] ? offset[NR_COLUMNS] : 1);
+  if (!payload)
+    return -1;
+
+  arrive_time = (int64_t *) (payload + offset[COL_ARRIVE_TIME]);
+  service_time = (int64_t *) (payload + offset[COL_SERVICE_TIME]);
+  id_offset = (uint64_t *) (payload + offset[COL_ID_OFFSET]);
+  type = (uint8_t *) (payload + offset[COL_TYPE]);
+  priority = (uint8_t *) (payload + offset[COL_PRIORITY]);
+  ids = payload + offset[COL_ID];
+
+  // the gantt list keeps the input order, tasks is sorted by arrival
+  for (Node *n = s->gantt_list.head; n != NULL; n = n->next, i++) {
+    size_t len = strlen (n->id) + 1;
+
+    arrive_time[i] = s->table.arrive_time[n->task];
+    service_time[i] = s->table.service_time[n->task];
+    id_offset[i] = id_pos;
+    type[i] = s->table.type[n->task];
+    priority[i] = s->table.priority[n->task];
+    memcpy (ids + id_pos, n->id, len);
+    id_pos += len;
+  }
+  hdr.checksum = checksum (payload, offset[NR_COLUMNS], CHECKSUM_SEED);
+
+  fp = fopen (filename, "wb");
+  if (!fp) {
+    err = errno;
+    free (payload);
+    errno = err;
+    return -1;
+  }
+  if (fwrite (&hdr, sizeof(hdr), 1, fp) != 1
+      || fwrite (payload, 1, offset[NR_COLUMNS], fp) != offset[NR_COLUMNS]
+      || fclose (fp)) {
+    err = errno;
+    free (payload);
+    errno = err;
+    return -1;
+  }
+
+  free (payload);
+  return 0;
+}
+
+/* make tasks from the columns of a mapped binary workload */
+static int load_binary(Sched *s, const char *buf, size_t size, const char *filename) {
+
+  const BinaryHeader *hdr = (const BinaryHeader *) buf;
+  const char *payload = buf + sizeof(BinaryHeader);
+  uint64_t offset[NR_COLUMNS + 1];
+  const int64_t *arrive_time;
+  const int64_t *service_time;
+  const uint64_t *id_offset;
+  const uint8_t *type;
+  const uint8_t *priority;
+  const char *ids;
+
+  if (hdr->version != BINARY_VERSION || hdr->header_size != sizeof(BinaryHeader)) {
+    ERR (s, "unsupported binary workload version in '%s'\n", filename);
+    return -1;
+  }
+
+  binary_layout (hdr->count, hdr->id_bytes, offset);
+  if (hdr->count > size || hdr->id_bytes > size
+      || sizeof(BinaryHeader) + offset[NR_COLUMNS] != size) {
+    ERR (s, "truncated binary workload '%s'\n", filename);
+    return -1;
+  }
+
+  if (checksum (payload, offset[NR_COLUMNS], CHECKSUM_SEED) != hdr->checksum) {
+    ERR (s, "checksum mismatch in binary workload '%s'\n", filename);
+    return -1;
+  }
+
+  arrive_time = (const int64_t *) (payload + offset[COL_ARRIVE_TIME]);
+  service_time = (const int64_t *) (payload + offset[COL_SERVICE_TIME]);
+  id_offset = (const uint64_t *) (payload + offset[COL_ID_OFFSET]);
+  type = (const uint8_t *) (payload + offset[COL_TYPE]);
+  priority = (const uint8_t *) (payload + offset[COL_PRIORITY]);
+  ids = payload + offset[COL_ID];
+
+  if (hdr->count >= NO_TASK) {
+    ERR (s, "too many tasks in binary workload '%s'\n", filename);
+    return -1;
+  }
+  // every id, the last one too, ends inside the mapping
+  if (hdr->count > 0 && (hdr->id_bytes == 0 || ids[hdr->id_bytes - 1] != '\0')) {
+    ERR (s, "unterminated id in binary workload '%s'\n", filename);
+    return -1;
+  }
+  if (hdr->count > 0 && grow_table (s, hdr->count))
+    return -1;
+
+  // binaries are also written by the generator, so the limits of this
+  // simulation are checked here like the parser does, record by record
+  for (uint64_t i = 0; i < hdr->count; i++) {
+    Task task;
+    const char *id = ids + id_offset[i];
+
+    if (type[i] > L || priority[i] < MIN_PRIORITY || priority[i] > MAX_PRIORITY
+        || arrive_time[i] < MIN_ARRIVE_TIME || service_time[i] < MIN_SERVICE_TIME
+        || id_offset[i] >= hdr->id_bytes) {
+      ERR (s, "invalid record %llu in binary workload '%s'\n", (unsigned long long) i, filename);
+      return -1;
+    }
+
+    if (check_valid_id (&s->limits, id, strlen (id))) {
+      ERR (s, "invalid id '%s' in record %llu, ignored\n", id, (unsigned long long) i);
+      s->ignored++;
+      continue;
+    }
+    if (arrive_time[i] > s->limits.max_arrive_time) {
+      ERR (s, "invalid arrive_time '%lld' in record %llu, ignored\n",
+           (long long) arrive_time[i], (unsigned long long) i);
+      s->ignored++;
+      continue;
+    }
+    if (service_time[i] > s->limits.max_service_time) {
+      ERR (s, "invalid service_time '%lld' in record %llu, ignored\n",
+           (long long) service_time[i], (unsigned long long) i);
+      s->ignored++;
+      continue;
+    }
+
+    task.type = type[i];
+    task.id = (char *) id;
+    task.arrive_time = arrive_time[i];
+    task.service_time = service_time[i];
+    task.priority = priority[i];
+    append_task (s, &task);
+  }
+
+  return 0;
+}
+
+/* next 64 random bits */
+static uint64_t gen_next(GenRng *r) {
+
+  uint64_t *s = r->s;
+  uint64_t result = ((s[1] * 5) << 7 | (s[1] * 5) >> 57) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = s[3] << 45 | s[3] >> 19;
+
+  return result;
+}
+
+/* uniform double in (0, 1), never 0 so its log is finite */
+static double gen_uniform(GenRng *r) {
+  return ((gen_next(r) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+/* seed stream number of a workload seed, expanded by splitmix64 */
+static void gen_seed(GenRng *r, uint64_t seed, uint64_t stream) {
+
+  uint64_t x = seed ^ (stream * 0x9e3779b97f4a7c15UL);
+
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15UL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9UL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebUL;
+    r->s[i] = z ^ (z >> 31);
+  }
+}
+
+/* index drawn from cumulative weights */
+static int gen_pick(GenRng *r, const double *cdf, int n) {
+
+  double u = gen_uniform(r) * cdf[n - 1];
+  int i = 0;
+
+  while (i < n - 1 && u >= cdf[i])
+    i++;
+
+  return i;
+}
+
+/* arrive time of the next task, arrivals never go back in time */
+static Time gen_arrive_time(GenState *g) {
+
+  const SchedGenConfig *c = g->config;
+
+  if (c->arrival == SCHED_ARRIVAL_BURSTY) {
+    // bursts arrive as a Poisson process, each a geometric number of tasks
+    if (g->burst_left == 0) {
+      g->clock -= log(gen_uniform(&g->arrive)) * c->burst_size / c->arrival_rate;
+      g->burst_left = 1;
+      if (c->burst_size > 1.0)
+        g->burst_left += (long long) floor(log(gen_uniform(&g->arrive))
+                                            / log(1.0 - 1.0 / c->burst_size));
+    }
+    g->burst_left--;
+  } else {
+    g->clock -= log(gen_uniform(&g->arrive)) / c->arrival_rate;
+  }
+
+  return (Time) g->clock;
+}
+
+/* service time of the next task, at least MIN_SERVICE_TIME */
+static Time gen_service_time(GenState *g) {
+
+  const SchedGenConfig *c = g->config;
+  double u = gen_uniform(&g->service);
+  double x;
+  Time t;
+
+  switch (c->service) {
+    case SCHED_SERVICE_PARETO:				// heavy tail, mean xm * alpha / (alpha - 1)
+      x = c->service_mean * (c->service_shape - 1.0) / c->service_shape
+          * pow(u, -1.0 / c->service_shape);
+      break;
+    case SCHED_SERVICE_LOGNORMAL: {		// shape is sigma of the normal
+      double sigma = c->service_shape;
+      double z = sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * gen_uniform(&g->service));
+
+      x = exp(log(c->service_mean) - sigma * sigma / 2.0 + sigma * z);
+      break;
+    }
+    default:
+      x = -c->service_mean * log(u);
+      break;
+  }
+
+  t = (x >= (double) c->max_service_time) ? c->max_service_time : llround(x);
+  return (t < MIN_SERVICE_TIME) ? MIN_SERVICE_TIME : t;
+}
+
+/* append bytes to the payload */
+static void gen_put(GenWriter *w, const void *p, size_t len) {
+
+  while (len > 0) {
+    size_t n = GEN_BUFFER_SIZE - w->len;
+
+    if (n > len) n = len;
+    memcpy(w->buf + w->len, p, n);
+    w->len += n;
+    w->pos += n;
+    p = (const char *) p + n;
+    len -= n;
+    if (w->len == GEN_BUFFER_SIZE)
+      gen_flush(w);
+  }
+}
+
+/* pad the payload to 8 bytes, the end of a column */
+static void gen_align(GenWriter *w) {
+
+  static const char zero[8];
+
+  gen_put(w, zero, (8 - w->pos % 8) % 8);
+}
+
+/* checksum and write the buffered payload, whole words only until the end */
+static int gen_flush(GenWriter *w) {
+
+  w->checksum = checksum(w->buf, w->len, w->checksum);
+  if (w->len > 0 && fwrite(w->buf, 1, w->len, w->fp) != w->len && !w->err)
+    w->err = errno ? errno : EIO;
+  w->len = 0;
+
+  return w->err ? -1 : 0;
+}
+
+/* decimal digits of v, zero padded to width, returns their number */
+static int gen_format(char *buf, unsigned long long v, int width) {
+
+  char digits[24];
+  int n = 0;
+
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v > 0 || n < width);
+
+  for (int i = 0; i < n; i++)
+    buf[i] = digits[n - 1 - i];
+
+  return n;
+}
+
+/* write the workload as task lines, the read_config() format */
+static int gen_text(GenState *g, FILE *fp) {
+
+  static const char type_name[3] = { 'H', 'M', 'L' };
+  char *buf = malloc(GEN_BUFFER_SIZE);
+  size_t len = 0;
+
+  if (!buf)
+    return -1;
+
+  for (long long i = 0; i < g->config->tasks; i++) {
+    if (len > GEN_BUFFER_SIZE - 128) {				// room for the longest line
+      if (fwrite(buf, 1, len, fp) != len) {
+        free(buf);
+        return -1;
+      }
+      len = 0;
+    }
+
+    // id, type, arrive time, service time and priority
+    buf[len++] = GEN_ID_PREFIX;
+    len += gen_format(buf + len, i, g->id_digits);
+    buf[len++] = ' ';
+    buf[len++] = type_name[gen_pick(&g->type, g->type_cdf, 3)];
+    buf[len++] = ' ';
+    len += gen_format(buf + len, gen_arrive_time(g), 0);
+    buf[len++] = ' ';
+    len += gen_format(buf + len, gen_service_time(g), 0);
+    buf[len++] = ' ';
+    len += gen_format(buf + len, 1 + gen_pick(&g->priority, g->priority_cdf, MAX_PRIORITY), 0);
+    buf[len++] = '\n';
+  }
+
+  if (len > 0 && fwrite(buf, 1, len, fp) != len) {
+    free(buf);
+    return -1;
+  }
+  free(buf);
+
+  return 0;
+}
+
+/* write the workload as a binary workload, one column after another */
+static int gen_binary(GenState *g, FILE *fp) {
+
+  const SchedGenConfig *c = g->config;
+  BinaryHeader hdr;
+  uint64_t offset[NR_COLUMNS + 1];
+  GenWriter w;
+  uint64_t count = c->tasks;
+  uint64_t id_len = 1 + g->id_digits + 1;
+  char id[24];
+
+  memset(&hdr, 0x00, sizeof(hdr));
+  memcpy(hdr.magic, BINARY_MAGIC, 8);
+  hdr.version = BINARY_VERSION;
+  hdr.header_size = sizeof(hdr);
+  hdr.count = count;
+  hdr.id_bytes = count * id_len;
+  binary_layout(hdr.count, hdr.id_bytes, offset);
+
+  memset(&w, 0x00, sizeof(w));
+  w.fp = fp;
+  w.checksum = CHECKSUM_SEED;
+  w.buf = malloc(GEN_BUFFER_SIZE);
+  if (!w.buf)
+    return -1;
+
+  // the header is written again once the checksum is known
+  if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1) {
+    free(w.buf);
+    return -1;
+  }
+
+  for (uint64_t i = 0; i < count; i++) {
+    int64_t v = gen_arrive_time(g);
+    gen_put(&w, &v, sizeof(v));
+  }
+  gen_align(&w);
+  for (uint64_t i = 0; i < count; i++) {
+    int64_t v = gen_service_time(g);
+    gen_put(&w, &v, sizeof(v));
+  }
+  gen_align(&w);
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t v = i * id_len;
+    gen_put(&w, &v, sizeof(v));
+  }
+  gen_align(&w);
+  for (uint64_t i = 0; i < count; i++) {
+    uint8_t v = gen_pick(&g->type, g->type_cdf, 3);
+    gen_put(&w, &v, 1);
+  }
+  gen_align(&w);
+  for (uint64_t i = 0; i < count; i++) {
+    uint8_t v = 1 + gen_pick(&g->priority, g->priority_cdf, MAX_PRIORITY);
+    gen_put(&w, &v, 1);
+  }
+  gen_align(&w);
+  id[0] = GEN_ID_PREFIX;
+  id[id_len - 1] = '\0';
+  for (uint64_t i = 0; i < count; i++) {
+    gen_format(id + 1, i, g->id_digits);
+    gen_put(&w, id, id_len);
+  }
+  gen_align(&w);
+
+  gen_flush(&w);
+  free(w.buf);
+  if (w.err || w.pos != offset[NR_COLUMNS]) {
+    errno = w.err ? w.err : EIO;
+    return -1;
+  }
+
+  hdr.checksum = w.checksum;
+  if (fseek(fp, 0, SEEK_SET) || fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+    return -1;
+
+  return 0;
+}
+
+/* get queue */
+static Queue *get_queue(Sched *s, Type type) {
+  switch(type) {
+    case H:
+      return s->H_queue;
+    case M:
+      return s->M_queue;
+    case L:
+      return s->L_queue;
+    default:
+      MSG("get_enqueue error no such queue type\n");
+      return NULL;
+  }
+}
+
+/* enqueue task to corresponding queue */
+static void enqueue_task(Sched *s, TaskRef new_task) {
+
+	Type task_type;
+	Queue *q;
+	int p;
+
+  if (new_task == NO_TASK) {
+    MSG("enqueue_task error no task is given\n");
+    return ;
+  }
+
+  task_type = s->table.type[new_task];
+  q = get_queue(s, task_type);					// get queue from task's type
+  PROF_COUNT(s, enqueues, 1);
+
+  if (task_type == H) {
+
+		// enqueue by its priority, FIFO among equal priorities
+    p = s->table.priority[new_task];
+    s->table.next[new_task] = NO_TASK;
+    if (q->bucket_head[p] == NO_TASK) {
+      q->bucket_head[p] = new_task;
+      q->occupied |= 1u << p;
+    } else {
+      s->table.next[q->bucket_tail[p]] = new_task;
+    }
+    q->bucket_tail[p] = new_task;
+    q->head = q->bucket_head[__builtin_ctz(q->occupied)];
+
+  } else if (task_type == M) {
+
+		// enqueue by its remaining time, FIFO among equal remaining times
+    s->table.next[new_task] = NO_TASK;
+    s->table.seq[new_task] = q->seq++;
+    heap_push(s, q, new_task);
+
+  } else if (is_empty(q)) {					// when queue is empty
+    s->table.next[new_task] = NO_TASK;
+    q->head = q->tail = new_task;
+  } else if (task_type == L) {
+
+		// FIFO implementation
+    s->table.next[new_task] = NO_TASK;
+    s->table.next[q->tail] = new_task;
+    q->tail = new_task;
+  }
+}
+
+/* dequeue a task from given queue */
+static TaskRef dequeue_task(Sched *s, Queue *q) {
+
+  TaskRef t;
+  int p;
+
+  if (is_empty(q)) {
+    MSG ("no element to dequeue\n");
+    return NO_TASK;
+  }
+
+	t = q->head;
+
+  if (q->type == H) {								// pop the highest priority bucket
+    p = __builtin_ctz(q->occupied);
+    q->bucket_head[p] = s->table.next[t];
+    if (q->bucket_head[p] == NO_TASK) {
+      q->bucket_tail[p] = NO_TASK;
+      q->occupied &= ~(1u << p);
+    }
+    q->head = q->occupied ? q->bucket_head[__builtin_ctz(q->occupied)] : NO_TASK;
+    s->table.next[t] = NO_TASK;
+  } else if (q->type == M) {				// pop the heap root
+    heap_pop(s, q);
+  } else if (q->head == q->tail) {
+    q->head = NO_TASK;
+    q->tail = NO_TASK;
+  } else {
+    q->head = s->table.next[q->head];
+    s->table.next[t] = NO_TASK;
+  }
+
+
+  return t;
+
+}
+
+/* check whether queue is empty */
+static bool is_empty(Queue *q) {
+  return (q->head == NO_TASK);
+}
+
+/* init queue */
+static void init_queue(Queue *q, Type type) {
+  memset(q, 0x00, sizeof(Queue));
+  q->type = type;
+  q->head = q->tail = NO_TASK;
+  for (int p = 0; p <= MAX_PRIORITY; p++)
+    q->bucket_head[p] = q->bucket_tail[p] = NO_TASK;
+}
+
+/* order of the M heap: shorter remaining time first, then enqueue order */
+static bool heap_before(Sched *s, TaskRef a, TaskRef b) {
+  if (s->table.remaining_time[a] != s->table.remaining_time[b])
+    return s->table.remaining_time[a] < s->table.remaining_time[b];
+  return s->table.seq[a] < s->table.seq[b];
+}
+
+/* push a task into the M heap */
+static void heap_push(Sched *s, Queue *q, TaskRef task) {
+
+  int i;
+  long walk = 0;
+
+  if (q->heap_size == q->heap_cap) {
+    int cap = q->heap_cap ? q->heap_cap * 2 : 64;
+    TaskRef *heap = (TaskRef *) realloc(q->heap, cap * sizeof(TaskRef));
+
+    if (!heap) {
+      MSG ("failed to grow the M queue: %s\n", STRERROR);
+      return;
+    }
+    q->heap = heap;
+    q->heap_cap = cap;
+  }
+
+  // sift up from the new leaf
+  for (i = q->heap_size++; i > 0; i = (i - 1) / 2) {
+    if (!heap_before(s, task, q->heap[(i - 1) / 2]))
+      break;
+    q->heap[i] = q->heap[(i - 1) / 2];
+    walk++;
+  }
+  q->heap[i] = task;
+  q->head = q->heap[0];
+
+  PROF_COUNT(s, enqueue_walk, walk);
+  if (PROFILE && walk > s->prof.max_enqueue_walk)
+    s->prof.max_enqueue_walk = walk;
+}
+
+/* pop the root of the M heap */
+static TaskRef heap_pop(Sched *s, Queue *q) {
+  return heap_remove(s, q, 0);
+}
+
+/* remove the task at position i of the M heap */
+static TaskRef heap_remove(Sched *s, Queue *q, int i) {
+
+  TaskRef removed;
+  TaskRef last;
+  int child;
+
+  removed = q->heap[i];
+  last = q->heap[--q->heap_size];
+
+  if (i < q->heap_size) {
+    // the last leaf takes the hole, sifted up or down from there
+    for (; i > 0 && heap_before(s, last, q->heap[(i - 1) / 2]); i = (i - 1) / 2)
+      q->heap[i] = q->heap[(i - 1) / 2];
+    for (; (child = 2 * i + 1) < q->heap_size; i = child) {
+      if (child + 1 < q->heap_size && heap_before(s, q->heap[child + 1], q->heap[child]))
+        child++;
+      if (!heap_before(s, q->heap[child], last))
+        break;
+      q->heap[i] = q->heap[child];
+    }
+    q->heap[i] = last;
+  }
+  q->head = q->heap_size > 0 ? q->heap[0] : NO_TASK;
+
+  return removed;
+}
+
+/* ticks until the next arrival, quantum expiry or completion on any core */
+static Time next_event_span(Sched *s) {
+
+  Time span = -1;
+
+  if (s->tasks != NO_TASK)													// earliest pending arrival
+    span = s->table.arrive_time[s->tasks] - s->now;
+
+  for (int c = 0; c < s->nr_cpus; c++) {
+    CPU *core = &s->cpus[c];
+
+    if (core->stall > 0 && (span < 0 || core->stall < span))
+      span = core->stall;											// stolen task is taken
+    if (core->task == NO_TASK) continue;
+
+    if (span < 0 || s->table.remaining_time[core->task] < span)
+      span = s->table.remaining_time[core->task];	// task completes
+    // a quantum expiry only matters when another H or M task could take
+    // the cpu, otherwise the running task is picked again right away;
+    // shared queues hand it to whichever core schedules first, so there
+    // every expiry is an event
+    if (core->timeout > 0 && core->timeout < span
+        && ((s->placement == SCHED_PLACE_SHARED && s->nr_cpus > 1)
+            || !(is_empty(core->queue[H]) && is_empty(core->queue[M]))))
+      span = core->timeout;									// H or M quantum expires
+  }
+
+  // a core which just started running may have left queued work an idle
+  // core steals on the next tick
+  if (s->stealing && s->placement != SCHED_PLACE_SHARED && span > 1) {
+    for (int c = 0; c < s->nr_cpus; c++) {
+      CPU *core = &s->cpus[c];
+
+      if (core->task == NO_TASK && core->stall == 0 && is_empty(core->queue[H])
+          && is_empty(core->queue[M]) && is_empty(core->queue[L])
+          && find_victim(s, c) != NULL)
+        return 1;
+    }
+  }
+
+  return span < 1 ? 1 : span;
+}
+
+/* make core c the cpu the scheduling functions work on */
+static void switch_cpu(Sched *s, int c) {
+
+  s->cpu = &s->cpus[c];
+  s->H_queue = s->cpu->queue[H];
+  s->M_queue = s->cpu->queue[M];
+  s->L_queue = s->cpu->queue[L];
+}
+
+/* pick the core an arriving task is queued on */
+static int place_task(Sched *s, TaskRef task) {
+
+  int best = 0;
+
+  if (s->nr_cpus == 1 || s->placement == SCHED_PLACE_SHARED) return 0;
+
+  if (s->placement == SCHED_PLACE_ROUND_ROBIN) {
+    best = s->next_cpu;
+    s->next_cpu = (s->next_cpu + 1) % s->nr_cpus;
+    return best;
+  }
+
+  // least remaining service time, the lowest core on ties
+  for (int c = 1; c < s->nr_cpus; c++)
+    if (s->cpus[c].load < s->cpus[best].load)
+      best = c;
+
+  return best;
+}
+
+/* busiest core core c could steal a queued H or M task from, NULL if none */
+static CPU *find_victim(Sched *s, int c) {
+
+  CPU *victim = NULL;
+  Time victim_queued = 0;
+
+  for (int v = 0; v < s->nr_cpus; v++) {
+    CPU *core = &s->cpus[v];
+    TimeSum queued = core->load;
+
+    // a core without a running task runs its own queue next, or is
+    // still taking a stolen task
+    if (v == c || core->task == NO_TASK
+        || (is_empty(core->queue[H]) && is_empty(core->queue[M])))
+      continue;
+    queued -= s->table.remaining_time[core->task];
+    if (victim == NULL || queued > victim_queued) {
+      victim = core;
+      victim_queued = queued;
+    }
+  }
+
+  return victim;
+}
+
+/* let the idle core c take a queued H or M task from the busiest core */
+static bool steal_task(Sched *s, int c) {
+
+  CPU *thief = &s->cpus[c];
+  CPU *victim = find_victim(s, c);
+  Queue *q;
+  TaskRef t;
+
+  if (victim == NULL) return false;
+
+  if (!is_empty(victim->queue[H])) {
+    // the front of the lowest priority bucket, the first of that priority
+    // the victim would run; its tail would need a walk of the bucket
+    int p = 31 - __builtin_clz(victim->queue[H]->occupied);
+
+    q = victim->queue[H];
+    t = q->bucket_head[p];
+    q->bucket_head[p] = s->table.next[t];
+    if (q->bucket_head[p] == NO_TASK) {
+      q->bucket_tail[p] = NO_TASK;
+      q->occupied &= ~(1u << p);
+    }
+    q->head = q->occupied ? q->bucket_head[__builtin_ctz(q->occupied)] : NO_TASK;
+    s->table.next[t] = NO_TASK;
+  } else {
+    // the longest remaining time is on a leaf, the newest of equals
+    int longest;
+
+    q = victim->queue[M];
+    longest = q->heap_size / 2;
+    for (int i = longest + 1; i < q->heap_size; i++)
+      if (heap_before(s, q->heap[longest], q->heap[i]))
+        longest = i;
+    t = heap_remove(s, q, longest);
+  }
+
+  victim->load -= s->table.remaining_time[t];
+  thief->load += s->table.remaining_time[t];
+  thief->stall = s->migration_penalty;
+  thief->migrations++;
+
+  switch_cpu(s, c);
+  enqueue_task(s, t);
+
+  if (DEBUG) MSG ("cpu %d stole %s\n", c, s->table.id[t]);
+
+  return true;
+}
+
+/* long-term-scheduling function */
+static void long_term_schedule(Sched *s) {
+
+  TaskRef target;
+
+  // tasks is sorted by arrive time, so only its arrived prefix is admitted
+  while (s->tasks != NO_TASK && s->table.arrive_time[s->tasks] <= s->now) {
+    target = s->tasks;
+    s->tasks = s->table.next[s->tasks];
+    s->table.next[target] = NO_TASK;
+    switch_cpu(s, place_task(s, target));
+    s->cpu->load += s->table.remaining_time[target];
+    enqueue_task(s, target);
+  }
+}
+
+/* process task in cpu for the given number of ticks */
+static void process(Sched *s, Time ticks) {
+
+  int quantum;
+  Time expired;																			// quanta folded into ticks
+
+  if (s->cpu->stall > 0)														// taking a stolen task
+    s->cpu->stall -= ticks;
+  if (s->cpu->task == NO_TASK)
+    PROF_COUNT(s, idle_ticks, ticks);
+
+  if (s->cpu->task != NO_TASK) {
+
+    record_to_gantt(s, s->cpu->task, s->now, ticks);		// record to gantt node
+    if (s->table.remaining_time[s->cpu->task] == s->table.service_time[s->cpu->task])
+      s->table.start_time[s->cpu->task] = s->now;				// first run of the task
+    s->table.remaining_time[s->cpu->task] -= ticks;	// update remaining time of the task
+    s->cpu->load -= ticks;
+    s->cpu->busy += ticks;
+
+    if (s->table.remaining_time[s->cpu->task] == 0) {	// when task is done
+
+      TaskRef t = s->cpu->task;
+      Type type = s->table.type[t];
+      Time turn_around_time = s->now + ticks - s->table.arrive_time[t];	// complete time - arrive time
+      Time waiting_time = turn_around_time - s->table.service_time[t];
+      Time response_time = s->table.start_time[t] - s->table.arrive_time[t];
+
+      if (DEBUG) MSG ("task %s is done\n", s->table.id[t]);
+
+      // the metrics are complete here, nothing of the task is read later
+      s->cpu->completed++;
+      s->cpu->turn_around_time += turn_around_time;
+      s->cpu->waiting_time += waiting_time;
+      s->done[type]++;
+      s->turn_around_time[type] += turn_around_time;
+      s->waiting_time[type] += waiting_time;
+      s->response_time[type] += response_time;
+      hist_record(get_histogram(s, type, LAT_TURN_AROUND), turn_around_time);
+      hist_record(get_histogram(s, type, LAT_WAITING), waiting_time);
+      hist_record(get_histogram(s, type, LAT_RESPONSE), response_time);
+      if (s->streaming)
+        finish_task(s, t, s->now + ticks);					// report and release it now
+      s->cpu->task = NO_TASK;										// time is not ticking yet
+    }
+    if (s->cpu->timeout > 0) {			// update timeout value, L has none
+      if (ticks < s->cpu->timeout) {
+        s->cpu->timeout -= ticks;
+      } else {									// quanta expired without another task to run
+        quantum = (s->cpu->task_type == H) ? s->h_quantum : s->m_quantum;
+        expired = (ticks - s->cpu->timeout) / quantum + 1;
+        s->cpu->timeout = (quantum - (ticks - s->cpu->timeout) % quantum) % quantum;
+        if (s->cpu->timeout == 0)				// timeout_check counts the last one
+          expired--;
+        if (s->cpu->task_type == H)
+          PROF_COUNT(s, expire_h, expired);
+        else
+          PROF_COUNT(s, expire_m, expired);
+      }
+    }
+  }
+}
+
+/* short-term-scheduling function */
+static void short_term_schedule(Sched *s) {
+
+  TaskRef t;
+
+  if (s->cpu->task != NO_TASK) return;
+
+  if (s->cpu->task_type == H) { 						// it's time for H task
+    if (!is_empty(s->H_queue)) {						// if there is H task to be able to run
+      t = dequeue_task(s, s->H_queue);
+      s->cpu->task = t;
+    } else if (!is_empty(s->M_queue)) { 		// if there is M task to be able to run and 
+      t = dequeue_task(s, s->M_queue);				// no H task to be able to run 
+      s->cpu->task = t;
+      s->cpu->task_type = M;								// reset time quantum to M
+      s->cpu->timeout = s->m_quantum;
+    } else if (!is_empty(s->L_queue)) {		// if no H, M task to be able to run
+      t = dequeue_task(s, s->L_queue);
+      s->cpu->task = t;
+      s->cpu->task_type = L;
+      s->cpu->timeout = -1;								// no timeout for L task
+    }
+
+  } else if (s->cpu->task_type == M) { 		// it's time for M task 
+    if (!is_empty(s->M_queue)) {						// if there is M task to be able to run
+      t = dequeue_task(s, s->M_queue);
+      s->cpu->task = t;
+    } else if (!is_empty(s->H_queue)) {		// if there is H task to be able to run and
+      t = dequeue_task(s, s->H_queue);				// no M task to be able to run
+      s->cpu->task = t;
+      s->cpu->task_type = H;								// reset time quantum to H
+      s->cpu->timeout = s->h_quantum;
+    } else if (!is_empty(s->L_queue)) {		// if no H, M task to be able to run
+      t = dequeue_task(s, s->L_queue);
+      s->cpu->task = t;
+      s->cpu->task_type = L;
+      s->cpu->timeout = -1;								// no time out for L task
+    }
+
+  } else { 															// if L was running before or no task was run yet
+    if (!is_empty(s->H_queue)) {
+      t = dequeue_task(s, s->H_queue);				// if there is H task to be able to run
+      s->cpu->task = t;
+      s->cpu->task_type = H;								// reset time quantum
+      s->cpu->timeout = s->h_quantum;
+    } else if (!is_empty(s->M_queue)) {		// if there is M task to be able to run
+      t = dequeue_task(s, s->M_queue);
+      s->cpu->task = t;
+      s->cpu->task_type = M;								// reset time quantum
+      s->cpu->timeout = s->m_quantum;
+    } else if (!is_empty(s->L_queue)) {		// if no H, M task to be able to run
+      t = dequeue_task(s, s->L_queue);
+      s->cpu->task = t;
+      s->cpu->task_type = L;
+      s->cpu->timeout = -1;
+    } else {}
+  }
+}
+
+/* handle priority interrupt if there is */
+static void priority_interrupt_check(Sched *s) {
+
+  if (s->cpu->task == NO_TASK) return;
+
+  // if M is running then no preemption occur
+
+	// when H is running and more higher priority appear then interrupt
+  if (s->cpu->task_type == H) 
+  {
+    if (!is_empty(s->H_queue)) {
+      if (s->table.priority[s->H_queue->head] < s->table.priority[s->cpu->task]) {
+        TaskRef preempted_task = s->cpu->task;
+        TaskRef new_task = dequeue_task(s, s->H_queue);
+        s->cpu->task = new_task;
+        enqueue_task(s, preempted_task);
+        PROF_COUNT(s, preempt_h, 1);
+      }
+    }
+  } 
+	// when L is running and either H, M tasks appear then interrupt
+  else if (s->cpu->task_type == L) 
+  {
+    if (!is_empty(s->H_queue)) {
+      TaskRef preempted_task = s->cpu->task;
+      TaskRef new_task = dequeue_task(s, s->H_queue);
+      s->cpu->task = new_task;
+      // update time quantum to H
+      s->cpu->timeout = s->h_quantum;
+      s->cpu->task_type = H;
+      // preempted L task must handle first later
+			if (!is_empty(s->L_queue)) {
+				s->table.next[preempted_task] = s->L_queue->head;
+				s->L_queue->head = preempted_task;
+			} else {
+				enqueue_task(s, preempted_task);
+			}
+      PROF_COUNT(s, preempt_l, 1);
+    } else if (!is_empty(s->M_queue)) {
+      TaskRef preempted_task = s->cpu->task;
+      TaskRef new_task = dequeue_task(s, s->M_queue);
+      s->cpu->task = new_task;
+      // update time quantum to M
+      s->cpu->timeout = s->m_quantum;
+      s->cpu->task_type = M;
+      // preempted L task must handle first later
+			if (!is_empty(s->L_queue)) {
+				s->table.next[preempted_task] = s->L_queue->head;
+				s->L_queue->head = preempted_task;
+			} else {
+				enqueue_task(s, preempted_task);
+			}
+      PROF_COUNT(s, preempt_l, 1);
+    }
+  }
+}
+
+/* handle timeout if there is */
+static void timeout_check(Sched *s) {
+
+	TaskRef preempted_task;
+
+
+	// switcing H to M task
+  if (s->cpu->task_type == H && s->cpu->timeout == 0) {
+
+    PROF_COUNT(s, expire_h, 1);
+    s->cpu->task_type = M;
+    s->cpu->timeout = s->m_quantum;
+    // remove task
+		if (s->cpu->task != NO_TASK) {
+			preempted_task = s->cpu->task;
+			enqueue_task(s, preempted_task);
+			s->cpu->task = NO_TASK;
+		}
+
+	// switching M to H
+  } else if (s->cpu->task_type == M && s->cpu->timeout == 0) {
+
+    PROF_COUNT(s, expire_m, 1);
+    s->cpu->task_type = H;
+    s->cpu->timeout = s->h_quantum;
+    // remove task
+		if (s->cpu->task != NO_TASK) {
+			preempted_task = s->cpu->task;
+			enqueue_task(s, preempted_task);
+			s->cpu->task = NO_TASK;
+		}
+  }
+
+  return;
+}
+
+/* average of the sums by Type over all completed tasks, each sum weighted
+   by the weight of its Type */
+static double get_average(Sched *s, const TimeSum *sum) {
+
+  long done = 0;
+  double total = 0.0;
+
+  for (Type type = H; type <= L; type++) {
+    done += s->done[type];
+    total += s->weight[type] * (double) sum[type];
+  }
+
+  return done ? total / done : 0.0;
+}
+
+/* sweep thread: simulate whole combinations of quanta on clones of the workload */
+static void *run_sweep(void *arg) {
+
+  SweepJob *job = arg;
+  int i;
+
+  while ((i = __atomic_fetch_add (&job->next, 1, __ATOMIC_RELAXED)) < job->nr_runs) {
+    SchedConfig config = job->config;
+    Sched *s;
+
+    config.h_quantum = job->h_min + i / job->nr_m;
+    config.m_quantum = job->m_min + i % job->nr_m;
+
+    s = sched_clone (job->workload, &config);
+    if (!s) {
+      MSG ("failed to simulate quanta %d,%d: %s\n", config.h_quantum, config.m_quantum, STRERROR);
+      __atomic_fetch_add (&job->failed, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+    sched_run (s);
+    sched_result (s, &job->results[i]);
+    sched_destroy (s);
+  }
+
+  return NULL;
+}
+
+/* batch thread: simulate whole workload files, output is kept in memory */
+static void *run_batch(void *arg) {
+
+  BatchJob *job = arg;
+  int i;
+
+  while ((i = __atomic_fetch_add (&job->next, 1, __ATOMIC_RELAXED)) < job->nr_files) {
+    BatchReport *report = &job->reports[i];
+    SchedConfig config = job->config;
+    FILE *out = open_memstream (&report->out, &report->out_len);
+    FILE *err = open_memstream (&report->err, &report->err_len);
+    Sched *s = NULL;
+
+    job->results[i].tasks = -1;
+    if (out && err) {
+      config.out = out;
+      config.err = err;
+      s = sched_create (&config);
+    }
+
+    if (!s) {
+      fprintf (err ? err : stderr, "failed to simulate '%s': %s\n", job->files[i], STRERROR);
+      __atomic_fetch_add (&job->failed, 1, __ATOMIC_RELAXED);
+    } else if (sched_load (s, job->files[i])) {
+      __atomic_fetch_add (&job->failed, 1, __ATOMIC_RELAXED);
+    } else {
+      sched_run (s);
+      sched_result (s, &job->results[i]);
+      sched_report (s, out);
+    }
+    sched_destroy (s);
+    if (out) fclose (out);
+    if (err) fclose (err);
+
+    pthread_mutex_lock (&job->lock);
+    report->done = true;
+    print_batch_reports (job);
+    pthread_mutex_unlock (&job->lock);
+  }
+
+  return NULL;
+}
+
+/* print the outputs which are done and follow the ones printed, with the lock held */
+static void print_batch_reports(BatchJob *job) {
+
+  FILE *out = job->config.out ? job->config.out : stdout;
+  FILE *err = job->config.err ? job->config.err : stderr;
+
+  while (job->printed < job->nr_files && job->reports[job->printed].done) {
+    BatchReport *report = &job->reports[job->printed];
+
+    if (report->out_len > 0) {
+      fprintf (out, "==> %s <==", job->files[job->printed]);
+      fwrite (report->out, 1, report->out_len, out);
+      fprintf (out, "\n");
+    }
+    if (report->err_len > 0) {
+      fprintf (err, "==> %s <==\n", job->files[job->printed]);
+      fwrite (report->err, 1, report->err_len, err);
+    }
+    free (report->out);
+    free (report->err);
+    report->out = report->err = NULL;
+    job->printed++;
+  }
+}
+
+
+/** library entry points **/
+
+/* defaults of the assignment workloads, one core */
+void sched_default_config(SchedConfig *config) {
+
+  long nr = sysconf (_SC_NPROCESSORS_ONLN);
+
+  memset (config, 0x00, sizeof(SchedConfig));
+  config->id_len = ID_LEN;
+  config->max_arrive_time = MAX_ARRIVE_TIME;
+  config->max_service_time = MAX_SERVICE_TIME;
+  config->parse_threads = (nr < 1) ? 1 : (nr > MAX_PARSE_THREADS) ? MAX_PARSE_THREADS : nr;
+  config->nr_cpus = 1;
+  config->placement = SCHED_PLACE_LEAST_LOADED;
+  config->h_quantum = H_TIME_QUANTUM;
+  config->m_quantum = M_TIME_QUANTUM;
+  for (int i = 0; i < 3; i++)
+    config->type_weight[i] = 1.0;
+}
+
+/* limits of the large workload mode */
+void sched_large_limits(SchedConfig *config) {
+
+  config->id_len = LARGE_ID_LEN;
+  config->max_arrive_time = LARGE_MAX_TIME;
+  config->max_service_time = LARGE_MAX_TIME;
+}
+
+/* new simulation with its cores and their queues */
+Sched *sched_create(const SchedConfig *config) {
+
+  Sched *s;
+
+  if (config->id_len < 2
+      || config->max_arrive_time < MIN_ARRIVE_TIME || config->max_arrive_time > MAX_TIME_LIMIT
+      || config->max_service_time < MIN_SERVICE_TIME || config->max_service_time > MAX_TIME_LIMIT
+      || config->parse_threads < 1 || config->nr_cpus < 1
+      || config->placement > SCHED_PLACE_SHARED || config->migration_penalty < 0
+      || config->h_quantum < 1 || config->m_quantum < 1
+      || config->type_weight[H] < 0.0 || config->type_weight[M] < 0.0
+      || config->type_weight[L] < 0.0) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  pthread_once (&simd_once, init_simd);
+
+  s = (Sched *) calloc (1, sizeof(Sched));
+  if (!s)
+    return NULL;
+
+  s->limits.id_len = config->id_len;
+  s->limits.max_arrive_time = config->max_arrive_time;
+  s->limits.max_service_time = config->max_service_time;
+  s->parse_threads = (config->parse_threads > MAX_PARSE_THREADS)
+                     ? MAX_PARSE_THREADS : config->parse_threads;
+  s->out = config->out ? config->out : stdout;
+  s->err = config->err ? config->err : stderr;
+  s->nr_cpus = config->nr_cpus;
+  s->placement = config->placement;
+  s->stealing = config->stealing;
+  s->migration_penalty = config->migration_penalty;
+  s->h_quantum = config->h_quantum;
+  s->m_quantum = config->m_quantum;
+  s->percentiles = config->percentiles;
+  for (Type type = H; type <= L; type++)
+    s->weight[type] = config->type_weight[type];
+  s->tasks = NO_TASK;
+  s->tasks_tail = NO_TASK;
+
+  /* latency histograms, the pages of buckets never hit are not touched */
+  s->latency = (Histogram *) calloc(3 * NR_LATENCIES, sizeof(Histogram));
+  if (!s->latency) {
+    free(s);
+    return NULL;
+  }
+
+  /* initialize CPUs and their queues */
+  s->cpus = (CPU *) arena_alloc(&s->arena, s->nr_cpus * sizeof(CPU));
+  if (!s->cpus) {
+    MSG ("failed to allocate %d cpus: %s\n", s->nr_cpus, STRERROR);
+    free(s->latency);
+    free(s);
+    return NULL;
+  }
+  for (int c = 0; c < s->nr_cpus; c++) {
+    for (Type type = H; type <= L; type++) {
+      if (c > 0 && s->placement == SCHED_PLACE_SHARED) {		// all cores take from core 0's queues
+        s->cpus[c].queue[type] = s->cpus[0].queue[type];
+        continue;
+      }
+      s->cpus[c].queue[type] = (Queue *) arena_alloc(&s->arena, sizeof(Queue));
+      init_queue(s->cpus[c].queue[type], type);
+    }
+    s->cpus[c].timeout = -1;
+    s->cpus[c].task_type = L;
+    s->cpus[c].task = NO_TASK;
+    s->cpus[c].last_task = NO_TASK;
+  }
+  switch_cpu(s, 0);
+
+  return s;
+}
+
+/* new simulation of the tasks loaded into workload, sharing its input columns */
+Sched *sched_clone(const Sched *workload, const SchedConfig *config) {
+
+  const TaskTable *w = &workload->table;
+  Sched *s;
+
+  if (workload->streaming || workload->started) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  s = sched_create (config);
+  if (!s)
+    return NULL;
+  s->workload = workload;
+
+  // arrive, service time, type, priority and id are never written by a run
+  s->table.arrive_time = w->arrive_time;
+  s->table.service_time = w->service_time;
+  s->table.type = w->type;
+  s->table.priority = w->priority;
+  s->table.id = w->id;
+  s->table.count = s->table.cap = w->count;
+
+  // the rest is state of the run, without a gantt chart
+  if (w->count > 0) {
+    s->table.remaining_time = malloc ((size_t) w->count * sizeof(Time));
+    s->table.seq = calloc (w->count, sizeof(unsigned long));
+    s->table.next = malloc ((size_t) w->count * sizeof(TaskRef));
+    s->table.start_time = calloc (w->count, sizeof(Time));
+    if (!s->table.remaining_time || !s->table.seq || !s->table.next || !s->table.start_time) {
+      MSG ("failed to clone %u tasks: %s\n", w->count, STRERROR);
+      sched_destroy (s);
+      errno = ENOMEM;
+      return NULL;
+    }
+    memcpy (s->table.remaining_time, w->service_time, (size_t) w->count * sizeof(Time));
+    memcpy (s->table.next, w->next, (size_t) w->count * sizeof(TaskRef));
+  }
+  s->tasks = workload->tasks;
+
+  return s;
+}
+
+/* load a workload file, or open it as a stream read while running */
+int sched_load(Sched *s, const char *filename) {
+
+  if (s->workload != NULL) {
+    ERR (s, "cannot load tasks into a clone of a workload\n");
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (open_stream (s, filename)) {
+    ERR (s, "failed to open input stream '%s': %s\n", filename, STRERROR);
+    return -1;
+  }
+
+  if (!s->streaming && read_config (s, filename)) {
+    ERR (s, "failed to load input file '%s': %s\n", filename, STRERROR);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* write the loaded tasks as a binary workload */
+int sched_save_binary(Sched *s, const char *filename) {
+
+  if (s->streaming) {
+    ERR (s, "cannot convert a streamed input to a binary file\n");
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (write_binary (s, filename)) {
+    ERR (s, "failed to write binary file '%s': %s\n", filename, STRERROR);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* one pass of the scheduler, up to the next event */
+int sched_step(Sched *s) {
+
+  Time span;
+  bool idle = true;
+  uint64_t t = PROFILE ? prof_clock () : 0;
+
+  /* init time and running flag */
+  if (!s->started) {
+    s->started = true;
+    s->now = 0;
+    s->running = true;
+
+    /* streamed tasks are reported as they finish */
+    if (s->streaming)
+      fprintf(s->out, "\n[Multilevel Queue Scheduling]\n");
+  }
+
+  if (!s->running) return 0;
+
+  /* read streamed tasks up to the first one arriving later */
+  if (s->streaming)
+    read_stream(s);
+  PROF_PHASE(s, PHASE_STREAM, t);
+
+  /* long-term scheduling */
+  long_term_schedule(s);
+  PROF_PHASE(s, PHASE_LONG_TERM, t);
+
+  /* idle cores take queued work from the busiest core */
+  if (s->stealing && s->placement != SCHED_PLACE_SHARED) {
+    for (int c = 0; c < s->nr_cpus; c++) {
+      CPU *core = &s->cpus[c];
+
+      if (core->task == NO_TASK && core->stall == 0 && is_empty(core->queue[H])
+          && is_empty(core->queue[M]) && is_empty(core->queue[L]))
+        steal_task(s, c);
+    }
+  }
+  PROF_PHASE(s, PHASE_STEAL, t);
+
+  /* short_term_scheduling, each core alternates its own queues */
+  for (int c = 0; c < s->nr_cpus; c++) {
+    switch_cpu(s, c);
+    if (s->cpu->stall > 0) {
+      // still taking a stolen task
+    } else if (s->cpu->task == NO_TASK) {
+      short_term_schedule(s);
+    } else {
+      // handle interrupt here
+      priority_interrupt_check(s);
+    }
+    if (PROFILE && s->cpu->task != NO_TASK && s->cpu->task != s->cpu->last_task) {
+      s->prof.context_switches++;
+      s->cpu->last_task = s->cpu->task;
+    }
+
+    /* process a task in CPU */
+    if (DEBUG) {
+      if (s->cpu->task == NO_TASK) {
+        MSG("cpu %d is empty\n", c);
+      } else {
+        MSG("cpu %d %s \n", c, s->table.id[s->cpu->task]);
+        MSG("%d\n", is_empty(s->M_queue));
+      }
+    }
+  }
+
+  PROF_PHASE(s, PHASE_SHORT_TERM, t);
+
+  /* nothing can change before the next event, run up to it at once */
+  span = EVENT_DRIVEN ? next_event_span(s) : 1;
+
+  /* the clock grows by the service times of all tasks, stop before it overflows */
+  if (span > LLONG_MAX - s->now) {
+    ERR (s, "simulated time passed %lld ticks, stopped\n", s->now);
+    s->running = false;
+    return 0;
+  }
+
+  for (int c = 0; c < s->nr_cpus; c++) {
+    switch_cpu(s, c);
+
+    /* process a task */
+    process(s, span);
+
+    /* time out check */
+    timeout_check(s);
+
+    if (!(is_empty(s->H_queue) && is_empty(s->M_queue) && is_empty(s->L_queue)
+          && s->cpu->task == NO_TASK))
+      idle = false;
+  }
+
+  PROF_PHASE(s, PHASE_PROCESS, t);
+  PROF_COUNT(s, steps, 1);
+
+  /* increase time */
+  s->now += span;
+
+  /* check all tasks done */
+  if (s->tasks == NO_TASK && !s->stream && idle) {
+    s->running = false;
+  }
+
+  return s->running;
+}
+
+/* run the scheduler until all tasks are done */
+void sched_run(Sched *s) {
+
+  while (sched_step(s));
+}
+
+/* every combination of H and M quanta in the ranges, on threads */
+int sched_sweep(const Sched *workload, const SchedConfig *config,
+                int h_min, int h_max, int m_min, int m_max,
+                int threads, SchedResult *results) {
+
+  SweepJob job;
+
+  if (workload->streaming) {
+    ERR (workload, "cannot sweep a streamed input\n");
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (h_min < 1 || h_max < h_min || m_min < 1 || m_max < m_min || threads < 1
+      || workload->started) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  memset (&job, 0x00, sizeof(job));
+  job.workload = workload;
+  job.config = *config;
+  job.h_min = h_min;
+  job.m_min = m_min;
+  job.nr_m = m_max - m_min + 1;
+  job.nr_runs = (h_max - h_min + 1) * job.nr_m;
+  job.results = results;
+
+  run_parallel ((threads < job.nr_runs) ? threads : job.nr_runs, run_sweep, &job);
+
+  return job.failed ? -1 : 0;
+}
+
+/* simulate workload files on threads, printing their outputs in order */
+int sched_batch(const char *const *files, int nr_files, const SchedConfig *config,
+                int threads, SchedResult *results) {
+
+  BatchJob job;
+
+  if (nr_files < 0 || threads < 1) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (nr_files == 0) return 0;
+
+  memset (&job, 0x00, sizeof(job));
+  job.files = files;
+  job.nr_files = nr_files;
+  job.config = *config;
+  job.config.parse_threads = 1;				// files are parsed side by side instead
+  job.results = results;
+  job.reports = calloc (nr_files, sizeof(BatchReport));
+  if (!job.reports)
+    return -1;
+  pthread_mutex_init (&job.lock, NULL);
+
+  run_parallel ((threads < nr_files) ? threads : nr_files, run_batch, &job);
+
+  pthread_mutex_destroy (&job.lock);
+  free (job.reports);
+
+  return job.failed ? -1 : 0;
+}
+
+/* defaults of a generated workload */
+void sched_gen_default_config(SchedGenConfig *config) {
+
+  memset (config, 0x00, sizeof(SchedGenConfig));
+  config->seed = 1;
+  config->tasks = 1000;
+  config->arrival = SCHED_ARRIVAL_POISSON;
+  config->arrival_rate = 0.2;
+  config->burst_size = 10.0;
+  config->service = SCHED_SERVICE_EXPONENTIAL;
+  config->service_mean = 4.0;
+  config->service_shape = 1.5;
+  config->max_service_time = LARGE_MAX_TIME;
+  for (int i = 0; i < 3; i++)
+    config->type_weight[i] = 1.0;
+  for (int i = 0; i < MAX_PRIORITY; i++)
+    config->priority_weight[i] = 1.0;
+}
+
+/* write a generated workload */
+int sched_generate(const SchedGenConfig *config, FILE *fp, bool binary) {
+
+  GenState g;
+  bool valid;
+
+  valid = config->tasks >= 0 && config->tasks < NO_TASK
+          && config->arrival_rate > 0.0 && config->burst_size >= 1.0
+          && config->service_mean >= MIN_SERVICE_TIME
+          && config->max_service_time >= MIN_SERVICE_TIME
+          && config->max_service_time <= MAX_TIME_LIMIT
+          && (config->service != SCHED_SERVICE_PARETO || config->service_shape > 1.0)
+          && (config->service != SCHED_SERVICE_LOGNORMAL || config->service_shape > 0.0);
+
+  memset (&g, 0x00, sizeof(g));
+  g.config = config;
+  for (int i = 0; i < 3; i++) {
+    valid = valid && config->type_weight[i] >= 0.0;
+    g.type_cdf[i] = config->type_weight[i] + (i ? g.type_cdf[i - 1] : 0.0);
+  }
+  for (int i = 0; i < MAX_PRIORITY; i++) {
+    valid = valid && config->priority_weight[i] >= 0.0;
+    g.priority_cdf[i] = config->priority_weight[i] + (i ? g.priority_cdf[i - 1] : 0.0);
+  }
+  if (!valid || g.type_cdf[2] <= 0.0 || g.priority_cdf[MAX_PRIORITY - 1] <= 0.0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  // a stream per column, so text and binary output hold the same tasks
+  gen_seed (&g.arrive, config->seed, 1);
+  gen_seed (&g.service, config->seed, 2);
+  gen_seed (&g.type, config->seed, 3);
+  gen_seed (&g.priority, config->seed, 4);
+  g.id_digits = count_digits ((config->tasks > 0) ? config->tasks - 1 : 0);
+
+  return binary ? gen_binary (&g, fp) : gen_text (&g, fp);
+}
+
+/* metrics of the run so far */
+void sched_result(Sched *s, SchedResult *result) {
+
+  result->h_quantum = s->h_quantum;
+  result->m_quantum = s->m_quantum;
+  result->cpu_time = s->now;
+  result->ignored = s->ignored;
+  result->tasks = 0;
+  for (Type type = H; type <= L; type++) {
+    long done = s->done[type];
+
+    result->tasks += done;
+    result->type_tasks[type] = done;
+    result->type_average_turn_around_time[type] = done ? ((double) s->turn_around_time[type]) / done : 0.0;
+    result->type_average_waiting_time[type] = done ? ((double) s->waiting_time[type]) / done : 0.0;
+  }
+  result->average_turn_around_time = get_average(s, s->turn_around_time);
+  result->average_waiting_time = get_average(s, s->waiting_time);
+}
+
+/* print result */
+void sched_report(Sched *s, FILE *fp) {
+
+  SchedResult result;
+
+  sched_result(s, &result);
+
+  if (!s->streaming) {
+    fprintf(fp, "\n[Multilevel Queue Scheduling]\n");
+    print_gantt(s, fp);
+  }
+  fprintf(fp, "\nCPU TIME: %lld\n", result.cpu_time);
+  fprintf(fp, "AVERAGE TURNAROUND TIME: %.2f\n", result.average_turn_around_time);
+  fprintf(fp, "AVERAGE WAITING TIME: %.2f\n", result.average_waiting_time);
+  if (s->nr_cpus > 1)
+    print_cpus(s, fp);
+  if (s->percentiles)
+    print_latency(s, fp);
+  if (PROFILE)
+    print_profile(s, s->err);
+}
+
+/* free the simulation */
+void sched_destroy(Sched *s) {
+
+  if (s == NULL) return;
+
+  free_run(s);
+  free(s->latency);
+  free(s);
+}
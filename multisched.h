@@ -0,0 +1,160 @@
+#ifndef MULTISCHED_H
+#define MULTISCHED_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+
+/** libmultisched, the multilevel queue scheduling simulator **/
+
+/* every simulation lives in its own Sched, so several of them can run in
+   one process, each from one thread at a time */
+typedef struct _Sched Sched;
+typedef struct _SchedConfig SchedConfig;
+typedef struct _SchedResult SchedResult;
+typedef struct _SchedGenConfig SchedGenConfig;
+
+/* core an arriving task is queued on */
+typedef enum _SchedPlacement {
+
+  SCHED_PLACE_LEAST_LOADED,   // core with the least remaining service time
+  SCHED_PLACE_ROUND_ROBIN,    // cores in turn
+  SCHED_PLACE_SHARED          // one set of queues shared by all cores
+} SchedPlacement;
+
+/* arrival process of generated tasks */
+typedef enum _SchedArrival {
+
+  SCHED_ARRIVAL_POISSON,      // exponential gaps between tasks
+  SCHED_ARRIVAL_BURSTY        // Poisson bursts of a geometric number of tasks
+} SchedArrival;
+
+/* service time distribution of generated tasks */
+typedef enum _SchedService {
+
+  SCHED_SERVICE_EXPONENTIAL,
+  SCHED_SERVICE_PARETO,       // heavy tail, shape is alpha > 1
+  SCHED_SERVICE_LOGNORMAL     // heavy tail, shape is sigma of the normal
+} SchedService;
+
+/* settings of a generated workload */
+struct _SchedGenConfig {
+
+  unsigned long long seed;    // the same seed gives the same workload
+  long long tasks;            // number of tasks
+
+  SchedArrival arrival;
+  double arrival_rate;        // mean tasks arriving per tick
+  double burst_size;          // mean tasks of a burst
+
+  SchedService service;
+  double service_mean;        // mean service time in ticks
+  double service_shape;       // alpha of Pareto, sigma of lognormal
+  long long max_service_time; // longer service times are cut to it
+
+  double type_weight[3];      // mix of H, M and L tasks
+  double priority_weight[10]; // weights of the priorities 1 to 10
+};
+
+/* settings of a simulation, fixed when it is created */
+struct _SchedConfig {
+
+  int id_len;                 // id string length limit
+  long long max_arrive_time;  // arrive time limit, at most 10^18 - 1
+  long long max_service_time; // service time limit, at most 10^18 - 1
+  int parse_threads;          // parser threads of large text workloads
+
+  int nr_cpus;                // simulated cores
+  SchedPlacement placement;   // core an arriving task is queued on
+  bool stealing;              // idle cores steal from busy ones
+  long long migration_penalty;  // ticks a core spends taking a stolen task
+  int h_quantum;              // time quantum of H tasks
+  int m_quantum;              // time quantum of M tasks
+  bool percentiles;           // report latency percentiles of each task type
+  double type_weight[3];      // weights of H, M and L tasks in the averages, 1 each
+
+  FILE *out;                  // streamed tasks are reported here, stdout if NULL
+  FILE *err;                  // diagnostics of the workload, stderr if NULL
+};
+
+/* metrics of a finished simulation */
+struct _SchedResult {
+
+  int h_quantum;              // time quantum of H tasks
+  int m_quantum;              // time quantum of M tasks
+  long long cpu_time;         // ticks until the last task was done
+  long tasks;                 // tasks done, -1 if the workload failed to load
+  long ignored;               // input lines ignored
+  double average_turn_around_time;   // weighted by the type weights
+  double average_waiting_time;       // weighted by the type weights
+
+  long type_tasks[3];         // tasks done of each of H, M and L
+  double type_average_turn_around_time[3];
+  double type_average_waiting_time[3];
+};
+
+/* defaults of the assignment workloads, one core */
+void sched_default_config(SchedConfig *config);
+
+/* limits of the large workload mode */
+void sched_large_limits(SchedConfig *config);
+
+/* new simulation, NULL with errno set if the config is invalid or
+   memory ran out */
+Sched *sched_create(const SchedConfig *config);
+
+/* new simulation of the tasks loaded into workload, which is only read
+   and must outlive it; it keeps no gantt chart, and workload must not
+   be streamed or run */
+Sched *sched_clone(const Sched *workload, const SchedConfig *config);
+
+/* load the tasks of a text or binary workload file, or stream them from
+   stdin ("-") or a file which is not regular, such as a FIFO; failures
+   are reported on stderr and return -1 */
+int sched_load(Sched *s, const char *filename);
+
+/* write the loaded tasks as a binary workload, -1 on failure */
+int sched_save_binary(Sched *s, const char *filename);
+
+/* run up to the next event, returns 1 while tasks are left, else 0 */
+int sched_step(Sched *s);
+
+/* run until all tasks are done */
+void sched_run(Sched *s);
+
+/* simulate the tasks of workload with every H quantum in h_min..h_max
+   and M quantum in m_min..m_max on a pool of threads, the rest taken from
+   config; the result of quanta h, m goes to
+   results[(h - h_min) * (m_max - m_min + 1) + m - m_min], -1 if any
+   combination failed */
+int sched_sweep(const Sched *workload, const SchedConfig *config,
+                int h_min, int h_max, int m_min, int m_max,
+                int threads, SchedResult *results);
+
+/* simulate nr_files workloads on a pool of threads, one simulation per
+   file, and put the result of each in results; reports and diagnostics
+   are written to config->out and config->err whole and in file order,
+   -1 if any file failed */
+int sched_batch(const char *const *files, int nr_files, const SchedConfig *config,
+                int threads, SchedResult *results);
+
+/* defaults of a generated workload: 1000 tasks arriving as a Poisson
+   process at 0.2 per tick, exponential service times of mean 4, an even
+   mix of types and priorities */
+void sched_gen_default_config(SchedGenConfig *config);
+
+/* write a generated workload to fp as task lines, or as a binary
+   workload when binary is true, which needs fp to be seekable; memory
+   does not grow with the number of tasks, -1 on failure */
+int sched_generate(const SchedGenConfig *config, FILE *fp, bool binary);
+
+/* metrics of the run so far */
+void sched_result(Sched *s, SchedResult *result);
+
+/* print the gantt chart and metrics of a finished run */
+void sched_report(Sched *s, FILE *fp);
+
+/* free the simulation and everything it allocated */
+void sched_destroy(Sched *s);
+
+#endif
@@ -0,0 +1,353 @@
+/* benchmarks of the scheduler, built into the library source so the hot
+   paths can be timed one by one */
+#include "libmultisched.c"
+
+#include <time.h>
+#include <sys/resource.h>
+
+#define BENCH_QUEUE_BATCH 1024					// queue operations timed at once
+#define BENCH_QUEUE_OPS (1 << 21)				// queue operations per depth
+#define BENCH_GANTT_OPS (1 << 21)				// gantt records per benchmark
+#define BENCH_GANTT_TASKS 1024					// tasks the gantt records go to
+
+static FILE *json;                      // results
+static bool first_result = true;        // no comma before it
+static bool quick;                      // smaller sizes
+
+/* monotonic time in nanoseconds */
+static double bench_ns() {
+
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* peak resident size of the process so far */
+static long max_rss_kb() {
+
+  struct rusage ru;
+
+  getrusage (RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+/* start a result object, the caller adds its fields and closes it */
+static void result_begin(const char *section, const char *name) {
+
+  fprintf (json, "%s\n    {\"section\": \"%s\", \"name\": \"%s\"",
+           first_result ? "" : ",", section, name);
+  first_result = false;
+}
+
+/* simulation with the large workload limits on one core */
+static Sched *bench_sched() {
+
+  SchedConfig config;
+  Sched *s;
+
+  sched_default_config (&config);
+  sched_large_limits (&config);
+  s = sched_create (&config);
+  if (!s) {
+    MSG ("failed to create a simulation: %s\n", STRERROR);
+    exit (1);
+  }
+
+  return s;
+}
+
+/* append n tasks of type (L + 1 for a mix) arriving at 0 */
+static TaskRef *bench_tasks(Sched *s, int n, int type, unsigned int seed) {
+
+  TaskRef *refs = malloc (n * sizeof(TaskRef));
+  static char id[] = "T0";
+
+  if (!refs) {
+    MSG ("failed to allocate %d tasks: %s\n", n, STRERROR);
+    exit (1);
+  }
+  srand (seed);
+  if (grow_table (s, n))
+    exit (1);
+
+  for (int i = 0; i < n; i++) {
+    Task task;
+
+    task.type = (type > L) ? rand () % 3 : type;
+    task.id = id;
+    task.arrive_time = 0;
+    task.service_time = 1 + rand () % 1000;
+    task.priority = 1 + rand () % MAX_PRIORITY;
+    refs[i] = append_task (s, &task);
+  }
+
+  return refs;
+}
+
+/* enqueue and dequeue batches on a queue kept at depth tasks */
+static void bench_queue(Type type, int depth) {
+
+  static const char *names = "HML";
+  Sched *s = bench_sched ();
+  TaskRef *refs = bench_tasks (s, depth + BENCH_QUEUE_BATCH, type, depth);
+  TaskRef *spare = refs + depth;					// tasks out of the queue
+  Queue *q;
+  double enqueue_ns = 0.0;
+  double dequeue_ns = 0.0;
+  long ops = 0;
+
+  s->tasks = NO_TASK;											// queued by hand instead
+  switch_cpu (s, 0);
+  q = get_queue (s, type);
+  for (int i = 0; i < depth; i++)
+    enqueue_task (s, refs[i]);
+
+  while (ops < BENCH_QUEUE_OPS) {
+    double t0 = bench_ns ();
+
+    for (int i = 0; i < BENCH_QUEUE_BATCH; i++)
+      enqueue_task (s, spare[i]);
+    enqueue_ns += bench_ns () - t0;
+
+    t0 = bench_ns ();
+    for (int i = 0; i < BENCH_QUEUE_BATCH; i++)
+      spare[i] = dequeue_task (s, q);
+    dequeue_ns += bench_ns () - t0;
+
+    // dequeued M tasks go back with a new remaining time
+    if (type == M)
+      for (int i = 0; i < BENCH_QUEUE_BATCH; i++)
+        s->table.remaining_time[spare[i]] = 1 + rand () % 1000;
+    ops += BENCH_QUEUE_BATCH;
+  }
+
+  result_begin ("micro", "enqueue_task");
+  fprintf (json, ", \"queue\": \"%c\", \"depth\": %d, \"ops\": %ld, \"ns_per_op\": %.2f}",
+           names[type], depth, ops, enqueue_ns / ops);
+  result_begin ("micro", "dequeue_task");
+  fprintf (json, ", \"queue\": \"%c\", \"depth\": %d, \"ops\": %ld, \"ns_per_op\": %.2f}",
+           names[type], depth, ops, dequeue_ns / ops);
+
+  free (refs);
+  sched_destroy (s);
+}
+
+/* admit n pending tasks of a mix at once, repeated on fresh simulations */
+static void bench_long_term(int n) {
+
+  int rounds = (n < BENCH_QUEUE_OPS / 8) ? BENCH_QUEUE_OPS / 8 / n : 1;
+  double ns = 0.0;
+
+  for (int r = 0; r < rounds; r++) {
+    Sched *s = bench_sched ();
+    TaskRef *refs = bench_tasks (s, n, L + 1, n + r);
+    double t0 = bench_ns ();
+
+    long_term_schedule (s);
+    ns += bench_ns () - t0;
+
+    free (refs);
+    sched_destroy (s);
+  }
+
+  result_begin ("micro", "long_term_schedule");
+  fprintf (json, ", \"depth\": %d, \"ops\": %ld, \"ns_per_op\": %.2f}",
+           n, (long) n * rounds, ns / ((double) n * rounds));
+}
+
+/* record runs to gantt nodes, new runs of interleaved tasks or extended ones */
+static void bench_gantt(bool extend) {
+
+  Sched *s = bench_sched ();
+  TaskRef *refs = bench_tasks (s, BENCH_GANTT_TASKS, L + 1, 1);
+  Time t = 0;
+  double t0;
+  double ns;
+
+  t0 = bench_ns ();
+  for (long i = 0; i < BENCH_GANTT_OPS; i++, t++)
+    record_to_gantt (s, refs[extend ? i * BENCH_GANTT_TASKS / BENCH_GANTT_OPS : i % BENCH_GANTT_TASKS], t, 1);
+  ns = bench_ns () - t0;
+
+  result_begin ("micro", "record_to_gantt");
+  fprintf (json, ", \"runs\": \"%s\", \"ops\": %d, \"ns_per_op\": %.2f}",
+           extend ? "extended" : "new", BENCH_GANTT_OPS, ns / BENCH_GANTT_OPS);
+
+  free (refs);
+  sched_destroy (s);
+}
+
+/* generated workload of n tasks at load service time per tick, in a temporary file */
+static char *bench_workload(long n, double load, bool binary) {
+
+  static char path[64];
+  SchedGenConfig config;
+  int fd;
+  FILE *fp;
+
+  snprintf (path, sizeof(path), "/tmp/schedbench-XXXXXX");
+  fd = mkstemp (path);
+  if (fd < 0 || !(fp = fdopen (fd, "w+"))) {
+    MSG ("failed to create a workload file: %s\n", STRERROR);
+    exit (1);
+  }
+
+  sched_gen_default_config (&config);
+  config.tasks = n;
+  config.arrival_rate = load / config.service_mean;
+  if (sched_generate (&config, fp, binary) || fclose (fp)) {
+    MSG ("failed to generate a workload: %s\n", STRERROR);
+    exit (1);
+  }
+
+  return path;
+}
+
+/* parse a text workload of n tasks */
+static void bench_read_config(long n) {
+
+  char *path = bench_workload (n, 0.9, false);
+  Sched *s = bench_sched ();
+  struct stat st;
+  double t0;
+  double ns;
+
+  stat (path, &st);
+  t0 = bench_ns ();
+  if (read_config (s, path))
+    MSG ("failed to read '%s': %s\n", path, STRERROR);
+  ns = bench_ns () - t0;
+
+  result_begin ("micro", "read_config");
+  fprintf (json, ", \"tasks\": %ld, \"ns_per_task\": %.2f, \"mb_per_sec\": %.2f}",
+           n, ns / n, st.st_size / (ns / 1e9) / 1e6);
+
+  sched_destroy (s);
+  unlink (path);
+}
+
+/* the main loop on a workload of n tasks, deeper queues at a higher load */
+static void bench_main_loop(long n, double load) {
+
+  char *path = bench_workload (n, load, true);
+  Sched *s = bench_sched ();
+  long steps = 0;
+  double t0;
+  double ns;
+
+  if (sched_load (s, path))
+    exit (1);
+  t0 = bench_ns ();
+  while (sched_step (s))
+    steps++;
+  ns = bench_ns () - t0;
+
+  result_begin ("micro", "main_loop");
+  fprintf (json, ", \"tasks\": %ld, \"load\": %.2f, \"ticks\": %lld, \"steps\": %ld, "
+           "\"ticks_per_sec\": %.0f, \"ns_per_step\": %.2f}",
+           n, load, s->now, steps, s->now / (ns / 1e9), ns / steps);
+
+  sched_destroy (s);
+  unlink (path);
+}
+
+/* load, run and report a generated workload of n tasks end to end */
+static void bench_macro(long n) {
+
+  char *path = bench_workload (n, 0.9, false);
+  Sched *s = bench_sched ();
+  FILE *null = fopen ("/dev/null", "w");
+  double t0;
+  double load_ns;
+  double run_ns;
+  double report_ns;
+
+  t0 = bench_ns ();
+  if (sched_load (s, path))
+    exit (1);
+  load_ns = bench_ns () - t0;
+
+  t0 = bench_ns ();
+  sched_run (s);
+  run_ns = bench_ns () - t0;
+
+  t0 = bench_ns ();
+  sched_report (s, null);
+  fflush (null);
+  report_ns = bench_ns () - t0;
+
+  result_begin ("macro", "workload");
+  fprintf (json, ", \"tasks\": %ld, \"ticks\": %lld, \"load_ms\": %.2f, \"run_ms\": %.2f, "
+           "\"report_ms\": %.2f, \"ticks_per_sec\": %.0f, \"max_rss_kb\": %ld}",
+           n, s->now, load_ns / 1e6, run_ns / 1e6, report_ns / 1e6,
+           s->now / (run_ns / 1e9), max_rss_kb ());
+
+  fclose (null);
+  sched_destroy (s);
+  unlink (path);
+}
+
+int main(int argc, char **argv) {
+
+  int opt;
+  static const int depths[] = { 1, 64, 4096, 262144 };
+  static const long sizes[] = { 1000, 10000, 100000, 1000000, 10000000 };
+  static const double loads[] = { 0.5, 0.9, 1.2 };
+  int nr_sizes = 5;
+
+  json = stdout;
+
+  while ((opt = getopt (argc, argv, "qo:")) != -1) {
+    switch (opt) {
+      case 'q':													// quick, up to 100k tasks
+        quick = true;
+        nr_sizes = 3;
+        break;
+      case 'o':													// json output file
+        json = fopen (optarg, "w");
+        if (!json) {
+          MSG ("failed to open '%s': %s\n", optarg, STRERROR);
+          return -1;
+        }
+        break;
+      default:
+        MSG ("usage: %s [-q] [-o json-file]\n", argv[0]);
+        return -1;
+    }
+  }
+
+  fprintf (json, "{\n  \"results\": [");
+
+  MSG ("queues\n");
+  for (Type type = H; type <= L; type++)
+    for (int d = 0; d < 4; d++)
+      bench_queue (type, depths[d]);
+
+  MSG ("long_term_schedule\n");
+  for (int d = 0; d < 4; d++)
+    bench_long_term (depths[d]);
+
+  MSG ("record_to_gantt\n");
+  bench_gantt (false);
+  bench_gantt (true);
+
+  MSG ("read_config\n");
+  for (int i = 0; i < nr_sizes && sizes[i] <= 1000000; i++)
+    bench_read_config (sizes[i]);
+
+  MSG ("main loop\n");
+  for (int l = 0; l < 3; l++)
+    bench_main_loop (quick ? 10000 : 100000, loads[l]);
+
+  for (int i = 0; i < nr_sizes; i++) {
+    MSG ("workload of %ld tasks\n", sizes[i]);
+    bench_macro (sizes[i]);
+  }
+
+  fprintf (json, "\n  ]\n}\n");
+  if (json != stdout)
+    fclose (json);
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "multisched.h"
+
+#define MSG(x...) fprintf (stderr, x)
+#define STRERROR  strerror (errno)
+
+
+/* read up to n comma separated weights, the ones left out are 0 */
+static int parse_weights(const char *str, double *weight, int n) {
+
+  char *end;
+  int i;
+
+  for (i = 0; i < n; i++)
+    weight[i] = 0.0;
+
+  for (i = 0; i < n; i++) {
+    weight[i] = strtod (str, &end);
+    if (end == str)
+      return -1;
+    if (*end == '\0')
+      return 0;
+    if (*end != ',')
+      return -1;
+    str = end + 1;
+  }
+
+  return -1;															// more weights than n
+}
+
+int main(int argc, char **argv) {
+
+  int opt;
+  SchedGenConfig config;
+  bool binary = false;
+  bool valid = true;
+  const char *filename = NULL;
+  FILE *fp = stdout;
+
+  sched_gen_default_config(&config);
+
+  while ((opt = getopt (argc, argv, "n:r:a:l:B:d:u:k:x:t:P:b")) != -1) {
+    switch (opt) {
+      case 'n':													// tasks
+        config.tasks = atoll (optarg);
+        break;
+      case 'r':													// seed
+        config.seed = strtoull (optarg, NULL, 0);
+        break;
+      case 'a':													// arrival process
+        if (!strcmp (optarg, "poisson"))
+          config.arrival = SCHED_ARRIVAL_POISSON;
+        else if (!strcmp (optarg, "bursty"))
+          config.arrival = SCHED_ARRIVAL_BURSTY;
+        else
+          valid = false;
+        break;
+      case 'l':													// arrivals per tick
+        config.arrival_rate = atof (optarg);
+        break;
+      case 'B':													// mean tasks of a burst
+        config.burst_size = atof (optarg);
+        break;
+      case 'd':													// service time distribution
+        if (!strcmp (optarg, "exp"))
+          config.service = SCHED_SERVICE_EXPONENTIAL;
+        else if (!strcmp (optarg, "pareto"))
+          config.service = SCHED_SERVICE_PARETO;
+        else if (!strcmp (optarg, "lognormal"))
+          config.service = SCHED_SERVICE_LOGNORMAL;
+        else
+          valid = false;
+        break;
+      case 'u':													// mean service time
+        config.service_mean = atof (optarg);
+        break;
+      case 'k':													// Pareto alpha or lognormal sigma
+        config.service_shape = atof (optarg);
+        break;
+      case 'x':													// longest service time
+        config.max_service_time = atoll (optarg);
+        break;
+      case 't':													// H, M, L mix
+        if (parse_weights (optarg, config.type_weight, 3))
+          valid = false;
+        break;
+      case 'P':													// weights of priorities 1 to 10
+        if (parse_weights (optarg, config.priority_weight, 10))
+          valid = false;
+        break;
+      case 'b':													// binary workload
+        binary = true;
+        break;
+      default:
+        valid = false;
+        break;
+    }
+  }
+
+  if (optind < argc)
+    filename = argv[optind++];
+
+  if (!valid || optind < argc || (binary && !filename))
+  {
+    MSG ("usage: %s [-n tasks] [-r seed] [-a poisson|bursty] [-l arrival-rate] [-B burst-size] [-d exp|pareto|lognormal] [-u service-mean] [-k service-shape] [-x max-service-time] [-t h,m,l] [-P w1,...,w10] [-b] [output-file]\n", argv[0]);
+    return -1;
+  }
+
+  if (filename && !(fp = fopen (filename, binary ? "wb" : "w")))
+  {
+    MSG ("failed to open output file '%s': %s\n", filename, STRERROR);
+    return -1;
+  }
+
+  if (sched_generate (&config, fp, binary))
+  {
+    if (errno == EINVAL)
+      MSG ("invalid workload settings\n");
+    else
+      MSG ("failed to write the workload: %s\n", STRERROR);
+    if (filename) fclose (fp);
+    return -1;
+  }
+
+  if ((filename ? fclose (fp) : fflush (fp)) != 0)
+  {
+    MSG ("failed to write the workload: %s\n", STRERROR);
+    return -1;
+  }
+
+  return 0;
+
+}